@@ -32,50 +32,139 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-#include <wiringPi.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "font.h"
 #include "lcd128x64.h"
-
-#define delay_ms(x) delay(x)
+#include "lcd128x64video.h"
 
 #define DEBUG 0
 
 #define OLED_CMD    0
 #define OLED_DATA   1
 
-// Hardware Pins
-#define OLED_SCL    21
-#define OLED_SDIN   22
-#define OLED_RST    23
-#define OLED_DC     24
-#define OLED_CS     25
-
-#define OLED_CS_Clr()   digitalWrite(OLED_CS, LOW);
-#define OLED_CS_Set()   digitalWrite(OLED_CS, HIGH);
+// Controller geometry: the SH1106 has 132 columns of RAM, of which the
+//	panel shows 128 starting at OLED_COL_OFFSET. With the SEG remap
+//	reversed the visible window starts from the other end of the RAM.
+#define OLED_RAM_WIDTH    132
+#define OLED_COL_OFFSET   2
 
-#define OLED_RST_Clr()  digitalWrite(OLED_RST, LOW);
-#define OLED_RST_Set()  digitalWrite(OLED_RST, HIGH);
+// Software copy of the framebuffer.
+//	Stored column by column in logical (drawing) coordinates: each
+//	column holds (1 << fbShift) page bytes, so in portrait mode the
+//	same 1K holds 64 columns of 16 pages.
+static uint8 frameBuffer [LCD_WIDTH*LCD_HEIGHT];
+static int32 fbShift = 3 ;
 
-#define OLED_DC_Clr()   digitalWrite(OLED_DC, LOW);
-#define OLED_DC_Set()   digitalWrite(OLED_DC, HIGH);
+#define FB(x,page)  frameBuffer [((x) << fbShift) + (page)]
 
-#define OLED_SCLK_Clr() digitalWrite(OLED_SCL, LOW);
-#define OLED_SCLK_Set() digitalWrite(OLED_SCL, HIGH);
+// Dirty spans: for every framebuffer page, the first and last column
+//	changed since the last flush (lo > hi when clean).
+#define FB_PAGES    (LCD_WIDTH / 8)
 
-#define OLED_SDIN_Clr() digitalWrite(OLED_SDIN, LOW);
-#define OLED_SDIN_Set() digitalWrite(OLED_SDIN, HIGH);
+static int32 dirtyLo [FB_PAGES], dirtyHi [FB_PAGES] ;
 
-// Software copy of the framebuffer
-static uint8 frameBuffer [LCD_WIDTH][LCD_HEIGHT];
+#define MARK(x,page) \
+  do { if ((x) < dirtyLo [page]) dirtyLo [page] = (x) ; \
+       if ((x) > dirtyHi [page]) dirtyHi [page] = (x) ; } while (0)
 
 static const uint8 BIT_SET[8] = {0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80};
 static const uint8 BIT_CLR[8] = {0xFE,0XFD,0XFB,0XF7,0XEF,0XDF,0XBF,0X7F};
 
 static int32 maxX = LCD_WIDTH,    maxY = LCD_HEIGHT*8;
 static int32 lastX,   lastY ;
+
+// Pixels outside the clip window are dropped. It is the whole screen
+//	except while a display list is rasterized one page at a time.
+static int32 clipX0 = 0, clipX1 = LCD_WIDTH ;
+static int32 clipY0 = 0, clipY1 = LCD_HEIGHT*8 ;
 static int32 mirrorX = 0, mirrorY = 0;
+static int32 rotation = 0 ;
+
+// Mirroring is done by the controller's SEG remap and COM scan
+//	direction registers when hwRemap is set, otherwise it is done in
+//	software while flushing. Either way drawing never sees it.
+static int32 hwRemap = 1 ;
+static int32 swMirrorX = 0, swMirrorY = 0 ;
+static int32 colOffset = OLED_COL_OFFSET ;
+static int32 segFlipped = 0, comFlipped = 0 ;
+
+// Frame hooks: after every update or flush that sent something, each
+//	hook is handed a shadow of what the panel now shows and the
+//	columns that changed. The shadow is only kept while hooks are set.
+#define MAX_FRAME_HOOKS   4
+
+static lcd128x64frameHook frameHooks [MAX_FRAME_HOOKS] ;
+static void  *frameHookArgs [MAX_FRAME_HOOKS] ;
+static int32  frameHookCount = 0 ;
+static uint8  panel [LCD_WIDTH * LCD_HEIGHT] ;
+static int32  frameLo [LCD_HEIGHT], frameHi [LCD_HEIGHT] ;
+static uint32 frameNumber = 0 ;
+
+// Display list: while recording, primitives are stored here instead of
+//	being drawn, and lcd128x64listPresent rasterizes them page by page.
+#define LIST_SIZE     256
+#define LIST_BMPS     16
+
+enum
+{
+  CMD_POINT, CMD_LINE, CMD_RECT, CMD_CIRCLE, CMD_ELLIPSE,
+  CMD_CHAR, CMD_BMP, CMD_BLIT, CMD_CLEAR
+} ;
+
+struct listCmd
+{
+  uint8 op ;
+  uint8 colour ;
+  uint8 arg ;		// filled, background colour or bitmap slot
+  uint8 cover ;		// overwrites every pixel of its bounds
+  short v [4] ;
+  short bx0, by0, bx1, by1 ;
+} ;
+
+static struct listCmd listCmds [LIST_SIZE] ;
+static const void    *listBmps [LIST_BMPS] ;
+static int32 listCount = 0, listBmpCount = 0 ;
+static int32 listRecording = 0 ;
+static int32 listLastX, listLastY ;
+
+// The commands touching each page, bucketed once by lcd128x64listPresent
+#if LIST_SIZE > 256
+#error "listPage holds command numbers in a byte"
+#endif
+static uint8 listPage [LIST_SIZE * FB_PAGES] ;
+
+static void listAdd (int32 op, int32 colour, int32 arg, int32 cover,
+                     int32 a, int32 b, int32 c, int32 d,
+                     int32 x0, int32 y0, int32 x1, int32 y1) ;
+static void fillRect (int32 x0, int32 y0, int32 x1, int32 y1, int32 colour) ;
+
+
+/*
+ * nullCommand: nullData:
+ *	The transport until one is set: everything is dropped, so the
+ *	driver can run with no display at all.
+ *********************************************************************************
+ */
+static void nullCommand (uint8 c)
+{
+  (void)c ;
+}
+
+static void nullData (const uint8 *buf, int32 len)
+{
+  (void)buf ;
+  (void)len ;
+}
+
+static const lcd128x64transport nullTransport = { nullCommand, nullData, 1, NULL } ;
+
+static const lcd128x64transport *transport = &nullTransport ;
+static uint32 bytesSent = 0 ;
 
 
 /*
@@ -85,77 +174,455 @@ static int32 mirrorX = 0, mirrorY = 0;
  */
 static void sendData (int32 dat, const int32 cmd)
 {
-  int32 i;
-  if(cmd)
+  uint8 b = (uint8)dat ;
+
+  if (cmd)
+    transport->data (&b, 1) ;
+  else
+    transport->command (b) ;
+  ++bytesSent ;
+}
+
+
+/*
+ * setCol: SetLine:
+ *	Set the column and line addresses
+ *********************************************************************************
+ */
+static void setPos(const int32 x, const int32 y)
+{
+  int32 col = x + colOffset ;
+
+  sendData(0xb0+y, OLED_CMD);
+  sendData(((col&0xf0)>>4)|0x10, OLED_CMD);
+  sendData(col&0x0f, OLED_CMD);
+}
+
+
+/*
+ * programRemap:
+ *	Load the SEG remap and COM scan direction registers for the
+ *	current mirror settings, or fall back to mirroring in software.
+ *********************************************************************************
+ */
+static void programRemap (void)
+{
+  int32 segFlip = 0, comFlip = 0 ;
+
+  if (hwRemap && transport->hwRemap)
   {
-    OLED_DC_Set();
+    segFlip   = mirrorX ;
+    comFlip   = mirrorY ;
+    swMirrorX = 0 ;
+    swMirrorY = 0 ;
   }
   else
   {
-    OLED_DC_Clr();
+    swMirrorX = mirrorX ;
+    swMirrorY = mirrorY ;
   }
-  OLED_CS_Clr();
-  for(i=0;i<8;i++)
+
+  sendData(segFlip ? 0xA0 : 0xA1, OLED_CMD);
+  sendData(comFlip ? 0xC0 : 0xC8, OLED_CMD);
+  segFlipped = segFlip ;
+  comFlipped = comFlip ;
+
+  colOffset = segFlip ? (OLED_RAM_WIDTH - LCD_WIDTH - OLED_COL_OFFSET) : OLED_COL_OFFSET ;
+}
+
+#ifndef __SSE2__
+/*
+ * transpose8:
+ *	Transpose an 8x8 bit matrix held one row per byte, so that bit j
+ *	of row b becomes bit b of row j.
+ *********************************************************************************
+ */
+static uint64 transpose8 (uint64 x)
+{
+  uint64 t ;
+
+  t = (x ^ (x >>  7)) & 0x00AA00AA00AA00AAULL ; x = x ^ t ^ (t <<  7) ;
+  t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL ; x = x ^ t ^ (t << 14) ;
+  t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL ; x = x ^ t ^ (t << 28) ;
+
+  return x ;
+}
+#endif
+
+
+/*
+ * buildPortraitPage:
+ *	Build one page of controller data from the portrait framebuffer,
+ *	rotated 90 degrees. Every 8 controller columns of the page come
+ *	from one 8x8 block of the framebuffer: 8 logical columns of a
+ *	single logical page, gathered, bit-transposed and stored in
+ *	reverse column order. 270 degrees is this plus mirroring X and Y.
+ *********************************************************************************
+ */
+static void buildPortraitPage (const int32 page, uint8 *line)
+{
+  int32 k, b, j, col, lpage ;
+
+#ifdef __SSE2__
+  uint8 rows [16] __attribute__ ((aligned (16))) ;
+  __m128i v ;
+#else
+  uint64 x ;
+#endif
+
+  col = page * 8 ;
+
+#ifdef __SSE2__
+// Two blocks at a time: the top bit of every byte lane is bit 7 of
+//	one row, so each movemask yields a transposed row of both blocks.
+
+  for (k = 0 ; k < LCD_WIDTH / 8 ; k += 2)
   {
-    OLED_SCLK_Clr();
-    if(dat&0x80)
+    lpage = maxY / 8 - 1 - k ;
+    for (b = 0 ; b < 8 ; ++b)
     {
-      OLED_SDIN_Set();
+      rows [b]     = FB (col + b, lpage) ;
+      rows [b + 8] = FB (col + b, lpage - 1) ;
     }
-    else
+    v = _mm_load_si128 ((const __m128i *)rows) ;
+    for (j = 7 ; j >= 0 ; --j)
+    {
+      int32 m = _mm_movemask_epi8 (v) ;
+      line [k * 8 + 7 - j]  = (uint8)m ;
+      line [k * 8 + 15 - j] = (uint8)(m >> 8) ;
+      v = _mm_slli_epi64 (v, 1) ;
+    }
+  }
+#else
+  for (k = 0 ; k < LCD_WIDTH / 8 ; ++k)
+  {
+    lpage = maxY / 8 - 1 - k ;
+    x = 0 ;
+    for (b = 0 ; b < 8 ; ++b)
+      x |= (uint64)FB (col + b, lpage) << (b * 8) ;
+    x = transpose8 (x) ;
+    for (j = 0 ; j < 8 ; ++j)
+      line [k * 8 + 7 - j] = (uint8)(x >> (j * 8)) ;
+  }
+#endif
+}
+
+
+/*
+ * reverse8:
+ *	Reverse the bit order of a byte.
+ *********************************************************************************
+ */
+static uint8 reverse8 (uint8 b)
+{
+  b = (uint8)(((b & 0xF0) >> 4) | ((b & 0x0F) << 4)) ;
+  b = (uint8)(((b & 0xCC) >> 2) | ((b & 0x33) << 2)) ;
+  b = (uint8)(((b & 0xAA) >> 1) | ((b & 0x55) << 1)) ;
+  return b ;
+}
+
+
+/*
+ * buildPage:
+ *	Build one page of controller data from the framebuffer.
+ *********************************************************************************
+ */
+static void buildPage (const int32 page, uint8 *line)
+{
+  int32 x, src ;
+  uint8 t ;
+
+  src = swMirrorY ? (LCD_HEIGHT - 1 - page) : page ;
+
+  if (rotation != 0)
+    buildPortraitPage (src, line) ;
+  else
+  {
+    for (x = 0 ; x < LCD_WIDTH ; ++x)
+      line [x] = FB (x, src) ;
+  }
+
+// Software mirror fallback
+
+  if (swMirrorY)
+  {
+    for (x = 0 ; x < LCD_WIDTH ; ++x)
+      line [x] = reverse8 (line [x]) ;
+  }
+
+  if (swMirrorX)
+  {
+    for (x = 0 ; x < LCD_WIDTH / 2 ; ++x)
     {
-      OLED_SDIN_Clr();
+      t = line [x] ;
+      line [x] = line [LCD_WIDTH - 1 - x] ;
+      line [LCD_WIDTH - 1 - x] = t ;
     }
-    OLED_SCLK_Set();
-    dat<<=1;
   }
-  OLED_CS_Set();
-  OLED_DC_Set();
 }
 
 
 /*
- * setCol: SetLine:
- *	Set the column and line addresses
+ * markDirty: clearDirty:
+ *	Maintain the dirty spans, given in framebuffer columns and pages.
  *********************************************************************************
  */
-static void setPos(const int32 x, const int32 y)
+static void markDirty (int32 x0, int32 x1, int32 page0, int32 page1)
 {
-  sendData(0xb0+y, OLED_CMD);
-  sendData(((x&0xf0)>>4)|0x10, OLED_CMD);
-  sendData((x&0x0f)|0x02, OLED_CMD);
+  int32 page ;
+
+  for (page = page0 ; page <= page1 ; ++page)
+  {
+    if (x0 < dirtyLo [page]) dirtyLo [page] = x0 ;
+    if (x1 > dirtyHi [page]) dirtyHi [page] = x1 ;
+  }
+}
+
+static void clearDirty (void)
+{
+  int32 page ;
+
+  for (page = 0 ; page < FB_PAGES ; ++page)
+  {
+    dirtyLo [page] = LCD_WIDTH ;
+    dirtyHi [page] = -1 ;
+  }
 }
 
+
 /*
- * lcd128x64update:
+ * lcd128x64update: sendPage:
  *	Copy our software version to the real display
  *********************************************************************************
  */
+static void sendPage (const int32 page, int32 x0, int32 x1)
+{
+  uint8 line [LCD_WIDTH] ;
+  uint8 *dst ;
+  int32 x, vp, v0, v1 ;
+
+  buildPage(page, line);
+  setPos(x0, page);
+  transport->data (line + x0, x1 - x0 + 1) ;
+  bytesSent += x1 - x0 + 1 ;
+
+  if (frameHookCount == 0)
+    return ;
+
+  // Keep the shadow as the panel shows it, remap registers applied
+
+  vp  = comFlipped ? (LCD_HEIGHT - 1 - page) : page ;
+  dst = panel + vp * LCD_WIDTH ;
+  v0  = segFlipped ? (LCD_WIDTH - 1 - x1) : x0 ;
+  v1  = segFlipped ? (LCD_WIDTH - 1 - x0) : x1 ;
+  for (x = x0 ; x <= x1 ; ++x)
+    dst [segFlipped ? (LCD_WIDTH - 1 - x) : x] = comFlipped ? reverse8 (line [x]) : line [x] ;
+
+  if (v0 < frameLo [vp]) frameLo [vp] = v0 ;
+  if (v1 > frameHi [vp]) frameHi [vp] = v1 ;
+}
+
+
+/*
+ * endFrame:
+ *	Tell the transport a frame is complete, and hand whatever was sent
+ *	since the last frame to the frame hooks.
+ *********************************************************************************
+ */
+static void endFrame (void)
+{
+  lcd128x64frame frame ;
+  int32 p, i, changed = 0 ;
+
+  if (transport->present != NULL)
+    transport->present () ;
+
+  if (frameHookCount == 0)
+    return ;
+
+  for (p = 0 ; p < LCD_HEIGHT ; ++p)
+  {
+    frame.lo [p] = frameLo [p] ;
+    frame.hi [p] = frameHi [p] ;
+    changed |= (frameLo [p] <= frameHi [p]) ;
+    frameLo [p] = LCD_WIDTH ;
+    frameHi [p] = -1 ;
+  }
+  if (!changed)
+    return ;
+
+  frame.panel  = panel ;
+  frame.number = ++frameNumber ;
+  for (i = 0 ; i < frameHookCount ; ++i)
+    frameHooks [i] (&frame, frameHookArgs [i]) ;
+}
+
 void lcd128x64update (void)
 {
-  int32 x=0, y=0;
+  int32 y=0;
+
   for(y=0; y<(LCD_HEIGHT); y++)
   {
-    setPos(0, y);
-    for(x=0; x<LCD_WIDTH; x++)
+    sendPage(y, 0, LCD_WIDTH - 1);
+  }
+  clearDirty () ;
+  endFrame () ;
+}
+
+
+/*
+ * lcd128x64flush:
+ *	Send only the parts of the display that changed since the last
+ *	update or flush. The dirty spans are kept in framebuffer terms and
+ *	mapped to controller pages and columns here; in portrait mode a
+ *	framebuffer page is a band of 8 controller columns.
+ *********************************************************************************
+ */
+void lcd128x64flush (void)
+{
+  int32 lo [LCD_HEIGHT], hi [LCD_HEIGHT] ;
+  int32 page, p, p0, p1, c0, c1, t ;
+
+  for (p = 0 ; p < LCD_HEIGHT ; ++p)
+  {
+    lo [p] = LCD_WIDTH ;
+    hi [p] = -1 ;
+  }
+
+  for (page = 0 ; page < maxY / 8 ; ++page)
+  {
+    if (dirtyLo [page] > dirtyHi [page])
+      continue ;
+
+    if (rotation == 0)
+    {
+      p0 = p1 = page ;
+      c0 = dirtyLo [page] ;
+      c1 = dirtyHi [page] ;
+    }
+    else
+    {
+      p0 = dirtyLo [page] / 8 ;
+      p1 = dirtyHi [page] / 8 ;
+      c0 = LCD_WIDTH - 8 - page * 8 ;
+      c1 = c0 + 7 ;
+    }
+
+    if (swMirrorX)
     {
-      sendData(frameBuffer[x][y], OLED_DATA);
+      t  = LCD_WIDTH - 1 - c0 ;
+      c0 = LCD_WIDTH - 1 - c1 ;
+      c1 = t ;
+    }
+
+    for (p = p0 ; p <= p1 ; ++p)
+    {
+      t = swMirrorY ? (LCD_HEIGHT - 1 - p) : p ;
+      if (c0 < lo [t]) lo [t] = c0 ;
+      if (c1 > hi [t]) hi [t] = c1 ;
     }
   }
+
+  for (p = 0 ; p < LCD_HEIGHT ; ++p)
+    if (lo [p] <= hi [p])
+      sendPage (p, lo [p], hi [p]) ;
+
+  clearDirty () ;
+  endFrame () ;
+}
+
+
+/*
+ * lcd128x64addFrameHook: lcd128x64removeFrameHook:
+ *	Add or remove a function called with every frame sent to the
+ *	panel, on the thread that sent it. Adding a hook marks the whole
+ *	screen dirty so the next frame brings the shadow up to date.
+ *	Returns -1 if all MAX_FRAME_HOOKS slots are taken.
+ *********************************************************************************
+ */
+int32 lcd128x64addFrameHook (lcd128x64frameHook hook, void *arg)
+{
+  int32 p ;
+
+  if ((hook == NULL) || (frameHookCount == MAX_FRAME_HOOKS))
+    return -1 ;
+
+  if (frameHookCount == 0)
+    for (p = 0 ; p < LCD_HEIGHT ; ++p)
+    {
+      frameLo [p] = LCD_WIDTH ;
+      frameHi [p] = -1 ;
+    }
+
+  frameHooks    [frameHookCount] = hook ;
+  frameHookArgs [frameHookCount] = arg ;
+  ++frameHookCount ;
+
+  markDirty (0, maxX - 1, 0, maxY / 8 - 1) ;
+  return 0 ;
+}
+
+void lcd128x64removeFrameHook (lcd128x64frameHook hook, void *arg)
+{
+  int32 i ;
+
+  for (i = 0 ; i < frameHookCount ; ++i)
+    if ((frameHooks [i] == hook) && (frameHookArgs [i] == arg))
+    {
+      --frameHookCount ;
+      frameHooks    [i] = frameHooks    [frameHookCount] ;
+      frameHookArgs [i] = frameHookArgs [frameHookCount] ;
+      return ;
+    }
 }
 
 
 /*
  * lcd128x64setOrientation:
  *	Set the display orientation:
- *	0: Normal, the display is portrait mode, 0,0 is top left
+ *	0: Normal, the display is landscape mode, 0,0 is top left
  *	1: Mirror x
  *	2: Mirror y
  *	3: Mirror x and y
+ *	4: Rotated 90 degrees clockwise, portrait mode 64x128
+ *	5: Rotated 270 degrees clockwise, portrait mode 64x128
+ *
+ *	Drawing always happens in logical coordinates. Mirroring is done
+ *	by the controller's remap registers (see lcd128x64setHardwareRemap)
+ *	and rotation while flushing. Switching between landscape and
+ *	portrait changes the framebuffer layout, so the framebuffer is
+ *	cleared.
  *********************************************************************************
  */
 void lcd128x64setOrientation (int32 orientation)
 {
+  int32 newRotation ;
+
+  if ((orientation < 0) || (orientation > 5))
+    return ;
+
+  newRotation = ((orientation == 4) || (orientation == 5)) ? 90 : 0 ;
+  if (newRotation != rotation)
+    memset (frameBuffer, 0, sizeof (frameBuffer)) ;
+
+  rotation = newRotation ;
+  if (rotation == 0)
+  {
+    fbShift = 3 ;
+    maxX    = LCD_WIDTH ;
+    maxY    = LCD_HEIGHT * 8 ;
+  }
+  else
+  {
+    fbShift = 4 ;
+    maxX    = LCD_HEIGHT * 8 ;
+    maxY    = LCD_WIDTH ;
+  }
+  clipX0 = 0 ; clipX1 = maxX ;
+  clipY0 = 0 ; clipY1 = maxY ;
+  clearDirty () ;
+  markDirty (0, maxX - 1, 0, maxY / 8 - 1) ;
+
   switch (orientation)
   {
     case 0:
@@ -174,13 +641,58 @@ void lcd128x64setOrientation (int32 orientation)
       break ;
 
     case 3:
+    case 5:
       mirrorX = 1 ;
       mirrorY = 1 ;
       break ;
       
     default:
+      mirrorX = 0 ;
+      mirrorY = 0 ;
       break;
   }
+
+  programRemap () ;
+}
+
+
+/*
+ * lcd128x64setHardwareRemap:
+ *	Choose whether mirroring is done by the controller (the default)
+ *	or in software while flushing, for controllers or transports that
+ *	can't remap. The current orientation is kept.
+ *********************************************************************************
+ */
+void lcd128x64setHardwareRemap (int32 enable)
+{
+  hwRemap = (enable != 0) ;
+  programRemap () ;
+}
+
+
+/*
+ * lcd128x64setTransport:
+ *	Send everything through t, or nowhere if t is NULL. A transport
+ *	that can't remap gets software mirroring. The setup functions of
+ *	the transports call this; see lcd128x64setup.
+ *********************************************************************************
+ */
+void lcd128x64setTransport (const lcd128x64transport *t)
+{
+  transport = (t != NULL) ? t : &nullTransport ;
+  programRemap () ;
+}
+
+
+/*
+ * lcd128x64bytesSent:
+ *	Return the number of command and data bytes sent so far, for
+ *	measuring what a frame costs on the bus.
+ *********************************************************************************
+ */
+uint32 lcd128x64bytesSent (void)
+{
+  return bytesSent ;
 }
 
 
@@ -212,25 +724,26 @@ void lcd128x64getScreenSize (int32 *x, int32 *y)
  */
 void lcd128x64point (int32 x, int32 y, int32 colour)
 {
-  if(mirrorX)
-    x = (maxX - x - 1);
-
-  if(mirrorY)
-    y = (maxY - y - 1);
+  if (listRecording)
+  {
+    listAdd (CMD_POINT, colour, 0, 1, x, y, 0, 0, x, y, x, y) ;
+    return ;
+  }
 
   lastX = x ;
   lastY = y ;
 
-  if((x < 0) || (x >= maxX) || (y < 0) || (y >= maxY))
+  if((x < clipX0) || (x >= clipX1) || (y < clipY0) || (y >= clipY1))
   return ;
 
+  MARK(x, y/8);
   if(colour)
   {
-    frameBuffer[x][y/8] |= BIT_SET[y%8];
+    FB(x, y/8) |= BIT_SET[y%8];
   }
   else
   {
-    frameBuffer[x][y/8] &= BIT_CLR[y%8];
+    FB(x, y/8) &= BIT_CLR[y%8];
   }
 }
 
@@ -241,16 +754,10 @@ void lcd128x64point (int32 x, int32 y, int32 colour)
  */
 int32 lcd128x64getpoint (int32 x, int32 y)
 {
-  if(mirrorX)
-    x = (maxX - x - 1);
-
-  if(mirrorY)
-    y = (maxY - y - 1);
-
   if((x < 0) || (x >= maxX) || (y < 0) || (y >= maxY))
   return -1;
 
-  if(frameBuffer[x][y/8] & BIT_SET[y%8])
+  if(FB(x, y/8) & BIT_SET[y%8])
   {
     return 1;
   }
@@ -263,17 +770,26 @@ int32 lcd128x64getpoint (int32 x, int32 y)
 
 /*
  * lcd128x64line: lcd128x64lineTo:
- *	Classic Bressenham Line code
+ *	Classic Bressenham Line code, in closed form so that only the rows
+ *	inside the clip window are visited: k steps along the major axis
+ *	from x0,y0 move floor ((2 * minor * k + major - 1) / (2 * major))
+ *	along the minor one, the same pixels as the stepping version. A
+ *	display list draws each page of a line without walking the rest.
  *********************************************************************************
  */
 void lcd128x64line (int32 x0, int32 y0, int32 x1, int32 y1, int32 colour)
 {
   int32 dx, dy ;
   int32 sx, sy ;
-  int32 err, e2 ;
+  int32 j, j0, j1, k, k0, k1 ;
 
-  lastX = x1 ;
-  lastY = y1 ;
+  if (listRecording)
+  {
+    listAdd (CMD_LINE, colour, 0, (x0 == x1) || (y0 == y1), x0, y0, x1, y1,
+             x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1,
+             x0 > x1 ? x0 : x1, y0 > y1 ? y0 : y1) ;
+    return ;
+  }
 
   dx = abs (x1 - x0) ;
   dy = abs (y1 - y0) ;
@@ -281,32 +797,81 @@ void lcd128x64line (int32 x0, int32 y0, int32 x1, int32 y1, int32 colour)
   sx = (x0 < x1) ? 1 : -1 ;
   sy = (y0 < y1) ? 1 : -1 ;
 
-  err = dx - dy ;
-  for (;;)
-  {
-    lcd128x64point (x0, y0, colour) ;
-    if ((x0 == x1) && (y0 == y1))
-      break ;
+// Rows y0 + sy * j for j0 <= j <= j1 are inside the clip window
 
-    e2 = 2 * err ;
+  j0 = (sy > 0) ? (clipY0 - y0) : (y0 - clipY1 + 1) ;
+  j1 = (sy > 0) ? (clipY1 - 1 - y0) : (y0 - clipY0) ;
+  if (j0 < 0)  j0 = 0 ;
+  if (j1 > dy) j1 = dy ;
 
-    if (e2 > -dy)
+  if (dy > dx)
+  {
+    for (j = j0 ; j <= j1 ; ++j)
     {
-      err -= dy ;
-      x0  += sx ;
+      k = (int32)(((long long)2 * dx * j + dy - 1) / (2 * dy)) ;
+      lcd128x64point (x0 + sx * k, y0 + sy * j, colour) ;
     }
+  }
+  else
+  {
+// Row j is the run of steps from the first that reaches it to the one
+//	before the first that reaches row j + 1
 
-    if (e2 < dx)
+    for (j = j0 ; j <= j1 ; ++j)
     {
-      err += dx ;
-      y0  += sy ;
+      k0 = (j == 0)  ? 0  : (int32)(((long long)2 * dx * j - dx + 2 * dy) / (2 * dy)) ;
+      k1 = (j == dy) ? dx : (int32)(((long long)2 * dx * (j + 1) - dx + 2 * dy) / (2 * dy)) - 1 ;
+      if (sx > 0)
+        fillRect (x0 + k0, y0 + sy * j, x0 + k1, y0 + sy * j, colour) ;
+      else
+        fillRect (x0 - k1, y0 + sy * j, x0 - k0, y0 + sy * j, colour) ;
     }
   }
+
+  lastX = x1 ;
+  lastY = y1 ;
 }
 
 void lcd128x64lineTo (int32 x, int32 y, int32 colour)
 {
-  lcd128x64line (lastX, lastY, x, y, colour) ;
+  if (listRecording)
+    lcd128x64line (listLastX, listLastY, x, y, colour) ;
+  else
+    lcd128x64line (lastX, lastY, x, y, colour) ;
+}
+
+
+/*
+ * fillRect:
+ *	Fill a rectangle, given as inclusive bounds with x0 <= x1 and
+ *	y0 <= y1, a page byte at a time within the clip window.
+ *********************************************************************************
+ */
+static void fillRect (int32 x0, int32 y0, int32 x1, int32 y1, int32 colour)
+{
+  int32 x, page, top, bot ;
+  uint8 mask ;
+
+  if (x0 < clipX0)      x0 = clipX0 ;
+  if (x1 > clipX1 - 1)  x1 = clipX1 - 1 ;
+  if (y0 < clipY0)      y0 = clipY0 ;
+  if (y1 > clipY1 - 1)  y1 = clipY1 - 1 ;
+  if ((x0 > x1) || (y0 > y1))
+    return ;
+
+  markDirty (x0, x1, y0 / 8, y1 / 8) ;
+  for (page = y0 / 8 ; page <= y1 / 8 ; ++page)
+  {
+    top  = (page == y0 / 8) ? (y0 & 7) : 0 ;
+    bot  = (page == y1 / 8) ? (y1 & 7) : 7 ;
+    mask = (uint8)((0xFF << top) & (0xFF >> (7 - bot))) ;
+    if (colour)
+      for (x = x0 ; x <= x1 ; ++x)
+        FB (x, page) |= mask ;
+    else
+      for (x = x0 ; x <= x1 ; ++x)
+        FB (x, page) &= (uint8)~mask ;
+  }
 }
 
 
@@ -317,34 +882,424 @@ void lcd128x64lineTo (int32 x, int32 y, int32 colour)
  */
 void lcd128x64rectangle (int32 x1, int32 y1, int32 x2, int32 y2, int32 colour, int32 filled)
 {
-  int32 x ;
+  if (listRecording)
+  {
+    listAdd (CMD_RECT, colour, filled, filled || (x1 == x2) || (y1 == y2), x1, y1, x2, y2,
+             x1 < x2 ? x1 : x2, y1 < y2 ? y1 : y2,
+             x1 > x2 ? x1 : x2, y1 > y2 ? y1 : y2) ;
+    return ;
+  }
+
   if (filled)
   {
-    if (x1 == x2)
-    {
-      lcd128x64line (x1, y1, x2, y2, colour) ;
-    }
-    else if (x1 < x2)
-    {
-      for (x = x1 ; x <= x2 ; ++x)
-      {
-        lcd128x64line (x, y1, x, y2, colour) ;
-      }
+    fillRect (x1 < x2 ? x1 : x2, y1 < y2 ? y1 : y2,
+              x1 > x2 ? x1 : x2, y1 > y2 ? y1 : y2, colour) ;
+    lastX = x1 > x2 ? x1 : x2 ;
+    lastY = y2 ;
+  }
+  else
+  {
+    lcd128x64line   (x1, y1, x2, y1, colour) ;
+    lcd128x64lineTo (x2, y2, colour) ;
+    lcd128x64lineTo (x1, y2, colour) ;
+    lcd128x64lineTo (x1, y1, colour) ;
+  }
+}
+
+
+/*
+ * lcd128x64points:
+ *	Plot a batch of pixels in one colour. The batch is checked against
+ *	the clip window once; if it is wholly inside, the bytes are written
+ *	with no per-pixel tests.
+ *********************************************************************************
+ */
+void lcd128x64points (const lcd128x64pt *pts, int32 n, int32 colour)
+{
+  int32 i, x, y ;
+  int32 minX, minY, maxPX, maxPY ;
+
+  if ((pts == NULL) || (n <= 0))
+    return ;
+
+  if (listRecording)
+  {
+    for (i = 0 ; i < n ; ++i)
+      lcd128x64point (pts [i].x, pts [i].y, colour) ;
+    return ;
+  }
+
+  minX = maxPX = pts [0].x ;
+  minY = maxPY = pts [0].y ;
+  for (i = 1 ; i < n ; ++i)
+  {
+    if (pts [i].x < minX)  minX  = pts [i].x ;
+    if (pts [i].x > maxPX) maxPX = pts [i].x ;
+    if (pts [i].y < minY)  minY  = pts [i].y ;
+    if (pts [i].y > maxPY) maxPY = pts [i].y ;
+  }
+
+  lastX = pts [n - 1].x ;
+  lastY = pts [n - 1].y ;
+
+  if ((minX < clipX0) || (maxPX >= clipX1) || (minY < clipY0) || (maxPY >= clipY1))
+  {
+    for (i = 0 ; i < n ; ++i)
+      lcd128x64point (pts [i].x, pts [i].y, colour) ;
+    return ;
+  }
+
+  markDirty (minX, maxPX, minY >> 3, maxPY >> 3) ;
+  if (colour)
+    for (i = 0 ; i < n ; ++i)
+    {
+      x = pts [i].x ; y = pts [i].y ;
+      FB (x, y >> 3) |= BIT_SET [y & 7] ;
     }
+  else
+    for (i = 0 ; i < n ; ++i)
+    {
+      x = pts [i].x ; y = pts [i].y ;
+      FB (x, y >> 3) &= BIT_CLR [y & 7] ;
+    }
+}
+
+
+/*
+ * fillCell:
+ *	Apply mask to size column bytes of one page, from column x0. With
+ *	a constant size this unrolls to a few stores.
+ *********************************************************************************
+ */
+static inline void fillCell (int32 x0, int32 page, int32 size, uint8 mask, int32 colour)
+{
+  uint8 *p = &FB (x0, page) ;
+  int32 stride = 1 << fbShift, i ;
+
+  if (colour)
+    for (i = 0 ; i < size ; ++i)
+      p [i * stride] |= mask ;
+  else
+    for (i = 0 ; i < size ; ++i)
+      p [i * stride] &= (uint8)~mask ;
+}
+
+
+/*
+ * lcd128x64cells:
+ *	Fill a batch of square cells of cellSize pixels, given in cell
+ *	coordinates, in one colour. Cell sizes that divide 8 never cross a
+ *	page, so each cell is a single mask applied to cellSize bytes.
+ *********************************************************************************
+ */
+void lcd128x64cells (const lcd128x64cell *cells, int32 n, int32 cellSize, int32 colour)
+{
+  int32 i, x0, y0 ;
+  int32 minX, minY, maxCX, maxCY ;
+  uint8 fill ;
+
+  if ((cells == NULL) || (n <= 0) || (cellSize <= 0))
+    return ;
+
+  minX = maxCX = cells [0].x ;
+  minY = maxCY = cells [0].y ;
+  for (i = 1 ; i < n ; ++i)
+  {
+    if (cells [i].x < minX)  minX  = cells [i].x ;
+    if (cells [i].x > maxCX) maxCX = cells [i].x ;
+    if (cells [i].y < minY)  minY  = cells [i].y ;
+    if (cells [i].y > maxCY) maxCY = cells [i].y ;
+  }
+
+  if (listRecording || (8 % cellSize != 0) ||
+      (minX * cellSize < clipX0) || ((maxCX + 1) * cellSize > clipX1) ||
+      (minY * cellSize < clipY0) || ((maxCY + 1) * cellSize > clipY1))
+  {
+    for (i = 0 ; i < n ; ++i)
+    {
+      x0 = cells [i].x * cellSize ;
+      y0 = cells [i].y * cellSize ;
+      lcd128x64rectangle (x0, y0, x0 + cellSize - 1, y0 + cellSize - 1, colour, 1) ;
+    }
+    return ;
+  }
+
+  markDirty (minX * cellSize, (maxCX + 1) * cellSize - 1, (minY * cellSize) >> 3, (maxCY * cellSize) >> 3) ;
+  fill = (uint8)((1 << cellSize) - 1) ;
+  for (i = 0 ; i < n ; ++i)
+  {
+    x0 = cells [i].x * cellSize ;
+    y0 = cells [i].y * cellSize ;
+    fillCell (x0, y0 >> 3, cellSize, (uint8)(fill << (y0 & 7)), colour) ;
+  }
+}
+
+
+/*
+ * lcd128x64spans:
+ *	Fill a batch of horizontal runs in one colour. The batch is checked
+ *	against the clip window once; if it is wholly inside, each run is
+ *	one bit set or cleared in a row of column bytes of its page, with
+ *	no per-pixel tests. Runs may be given either way round.
+ *********************************************************************************
+ */
+void lcd128x64spans (const lcd128x64hspan *spans, int32 n, int32 colour)
+{
+  int32 i, x, x0, x1, stride ;
+  int32 minX, minY, maxSX, maxSY ;
+  uint8 bit, *p ;
+
+  if ((spans == NULL) || (n <= 0))
+    return ;
+
+  minX = minY = 1 << 30 ;
+  maxSX = maxSY = -(1 << 30) ;
+  for (i = 0 ; i < n ; ++i)
+  {
+    x0 = spans [i].x0 < spans [i].x1 ? spans [i].x0 : spans [i].x1 ;
+    x1 = spans [i].x0 < spans [i].x1 ? spans [i].x1 : spans [i].x0 ;
+    if (x0 < minX)           minX  = x0 ;
+    if (x1 > maxSX)          maxSX = x1 ;
+    if (spans [i].y < minY)  minY  = spans [i].y ;
+    if (spans [i].y > maxSY) maxSY = spans [i].y ;
+  }
+
+  if (listRecording || (minX < clipX0) || (maxSX >= clipX1) || (minY < clipY0) || (maxSY >= clipY1))
+  {
+    for (i = 0 ; i < n ; ++i)
+      lcd128x64rectangle (spans [i].x0, spans [i].y, spans [i].x1, spans [i].y, colour, 1) ;
+    return ;
+  }
+
+  markDirty (minX, maxSX, minY >> 3, maxSY >> 3) ;
+  stride = 1 << fbShift ;
+  for (i = 0 ; i < n ; ++i)
+  {
+    x0  = spans [i].x0 < spans [i].x1 ? spans [i].x0 : spans [i].x1 ;
+    x1  = spans [i].x0 < spans [i].x1 ? spans [i].x1 : spans [i].x0 ;
+    p   = &FB (x0, spans [i].y >> 3) ;
+    bit = BIT_SET [spans [i].y & 7] ;
+    if (colour)
+      for (x = x0 ; x <= x1 ; ++x, p += stride)
+        *p |= bit ;
     else
+      for (x = x0 ; x <= x1 ; ++x, p += stride)
+        *p &= (uint8)~bit ;
+  }
+}
+
+
+/*
+ * lcd128x64cell1: lcd128x64cell2: lcd128x64cell4: lcd128x64cell8:
+ *	Fill one square cell, given in cell coordinates, with the size fixed
+ *	at compile time: a cell of 4 is a nibble in four column bytes of one
+ *	page, a cell of 8 is eight whole bytes. The loops have constant
+ *	bounds and unroll to a mask and a few stores. Cells not wholly in
+ *	the clip window, or drawn while recording, go through
+ *	lcd128x64rectangle.
+ *********************************************************************************
+ */
+#define	CELL_FN(size)							\
+void lcd128x64cell##size (int32 cx, int32 cy, int32 colour)		\
+{									\
+  int32 x0 = cx * size, y0 = cy * size, page = y0 >> 3 ;		\
+									\
+  if (listRecording || (x0 < clipX0) || (x0 + size > clipX1) ||		\
+      (y0 < clipY0) || (y0 + size > clipY1))				\
+  {									\
+    lcd128x64rectangle (x0, y0, x0 + size - 1, y0 + size - 1, colour, 1) ; \
+    return ;								\
+  }									\
+									\
+  MARK (x0, page) ;							\
+  MARK (x0 + size - 1, page) ;						\
+  fillCell (x0, page, size, (uint8)(((1 << size) - 1) << (y0 & 7)), colour) ; \
+}
+
+CELL_FN(1)
+CELL_FN(2)
+CELL_FN(4)
+CELL_FN(8)
+
+#undef	CELL_FN
+
+
+/*
+ * lcd128x64floodfill:
+ *	Fill the 4-connected region around x,y with the colour. Bytes run
+ *	down the columns, so this is a scanline fill turned on its side:
+ *	each span is a run of a column, grown and filled a page byte at a
+ *	time, and the neighbouring columns are scanned alongside it for
+ *	new seeds. Seeds go on a fixed-size stack; those it has no room
+ *	for wait in a bitmap laid out like the framebuffer until the stack
+ *	empties, so the fill always completes. 512 is well above what
+ *	mazes need (see tools/fillbench). Returns -1 if the seed is
+ *	off-screen.
+ *********************************************************************************
+ */
+#define FILL_STACK    512
+
+int32 lcd128x64floodfill (int32 x, int32 y, int32 colour)
+{
+  struct { uint8 x, y ; } stack [FILL_STACK] ;
+  uint8 spill [LCD_WIDTH*LCD_HEIGHT] ;
+  int32 sp = 0, spilled = 0, spillUsed = 0, rc ;
+  int32 y0, y1, nx, dx, ny, page, b ;
+  uint8 target, full ;
+
+  if ((x < clipX0) || (x >= clipX1) || (y < clipY0) || (y >= clipY1))
+    return -1 ;
+
+  if (listRecording)
+  {
+    lcd128x64listPresent (0) ;
+    rc = lcd128x64floodfill (x, y, colour) ;
+    lcd128x64listBegin   () ;
+    return rc ;
+  }
+
+  colour = (colour != 0) ;
+  target = !colour ;
+  full   = target ? 0xFF : 0x00 ;
+
+#define PIX(px,py)      ((FB (px, (py) >> 3) >> ((py) & 7)) & 1)
+#define SPILL(px,page)  spill [((px) << fbShift) + (page)]
+
+  if (PIX (x, y) != target)
+    return 0 ;
+
+  stack [sp].x = (uint8)x ; stack [sp].y = (uint8)y ; ++sp ;
+
+  for (;;)
+  {
+// Refill an empty stack from the seeds it had no room for
+
+    if ((sp == 0) && spilled)
     {
-      for (x = x2 ; x <= x1 ; ++x)
+      spilled = 0 ;
+      for (nx = clipX0 ; nx < clipX1 ; ++nx)
+        for (page = clipY0 >> 3 ; page <= (clipY1 - 1) >> 3 ; ++page)
+          while (SPILL (nx, page) != 0)
+          {
+            if (sp == FILL_STACK)
+            {
+              spilled = 1 ;
+              break ;
+            }
+            for (b = 0 ; !(SPILL (nx, page) & (1 << b)) ; ++b)
+              ;
+            SPILL (nx, page) &= (uint8)~(1 << b) ;
+            stack [sp].x = (uint8)nx ; stack [sp].y = (uint8)(page * 8 + b) ; ++sp ;
+          }
+    }
+    if (sp == 0)
+      break ;
+
+    --sp ;
+    x = stack [sp].x ;
+    y = stack [sp].y ;
+    if (PIX (x, y) != target)
+      continue ;
+
+// Grow the span up and down, a whole byte at a time where possible
+
+    y0 = y ;
+    while (y0 > clipY0)
+    {
+      if (((y0 & 7) == 0) && (y0 - 8 >= clipY0) && (FB (x, (y0 >> 3) - 1) == full))
+        y0 -= 8 ;
+      else if (PIX (x, y0 - 1) == target)
+        --y0 ;
+      else
+        break ;
+    }
+    y1 = y ;
+    while (y1 < clipY1 - 1)
+    {
+      if (((y1 & 7) == 7) && (y1 + 8 < clipY1) && (FB (x, (y1 >> 3) + 1) == full))
+        y1 += 8 ;
+      else if (PIX (x, y1 + 1) == target)
+        ++y1 ;
+      else
+        break ;
+    }
+
+    fillRect (x, y0, x, y1, colour) ;
+
+// Seed every run of the span's neighbours still to be filled
+
+    for (dx = -1 ; dx <= 1 ; dx += 2)
+    {
+      nx = x + dx ;
+      if ((nx < clipX0) || (nx >= clipX1))
+        continue ;
+
+      ny = y0 ;
+      while (ny <= y1)
       {
-        lcd128x64line (x, y1, x, y2, colour) ;
+        if (((ny & 7) == 0) && (ny + 7 <= y1) && (FB (nx, ny >> 3) == (uint8)~full))
+        {
+          ny += 8 ;
+          continue ;
+        }
+        if (PIX (nx, ny) != target)
+        {
+          ++ny ;
+          continue ;
+        }
+
+        if (sp < FILL_STACK)
+        {
+          stack [sp].x = (uint8)nx ; stack [sp].y = (uint8)ny ; ++sp ;
+        }
+        else
+        {
+          if (!spillUsed)
+          {
+            memset (spill, 0, sizeof (spill)) ;
+            spillUsed = 1 ;
+          }
+          SPILL (nx, ny >> 3) |= (uint8)(1 << (ny & 7)) ;
+          spilled = 1 ;
+        }
+
+        while ((ny <= y1) && (PIX (nx, ny) == target))
+        {
+          if (((ny & 7) == 0) && (ny + 7 <= y1) && (FB (nx, ny >> 3) == full))
+            ny += 8 ;
+          else
+            ++ny ;
+        }
       }
     }
   }
+
+#undef PIX
+#undef SPILL
+
+  return 0 ;
+}
+
+
+/*
+ * curveRow:
+ *	Plot the points x0,y and x1,y of a circle or ellipse, or the span
+ *	between them if filled. Rows outside the clip window are skipped
+ *	at once, so each page of a display list draws only its own rows.
+ *	Curves leave lcd128x64lineTo's position alone, recorded or not.
+ *********************************************************************************
+ */
+static void curveRow (int32 x0, int32 x1, int32 y, int32 colour, int32 filled)
+{
+  if ((y < clipY0) || (y >= clipY1))
+    return ;
+
+  if (filled)
+    fillRect (x0 < x1 ? x0 : x1, y, x0 > x1 ? x0 : x1, y, colour) ;
   else
   {
-    lcd128x64line   (x1, y1, x2, y1, colour) ;
-    lcd128x64lineTo (x2, y2, colour) ;
-    lcd128x64lineTo (x1, y2, colour) ;
-    lcd128x64lineTo (x1, y1, colour) ;
+    fillRect (x0, y, x0, y, colour) ;
+    fillRect (x1, y, x1, y, colour) ;
   }
 }
 
@@ -363,18 +1318,20 @@ void lcd128x64circle (int32 x, int32 y, int32 r, int32 colour, int32 filled)
   int32 x1 = 0 ;
   int32 y1 = r ;
 
-  if (filled)
+  if (listRecording)
   {
-    lcd128x64line (x, y + r, x, y - r, colour) ;
-    lcd128x64line (x + r, y, x - r, y, colour) ;
+    listAdd (CMD_CIRCLE, colour, filled, 0, x, y, r, 0, x - r, y - r, x + r, y + r) ;
+    return ;
   }
+
+  if (filled)
+    fillRect (x, y - abs (r), x, y + abs (r), colour) ;
   else
   {
-    lcd128x64point (x, y + r, colour) ;
-    lcd128x64point (x, y - r, colour) ;
-    lcd128x64point (x + r, y, colour) ;
-    lcd128x64point (x - r, y, colour) ;
+    curveRow (x, x, y + r, colour, 0) ;
+    curveRow (x, x, y - r, colour, 0) ;
   }
+  curveRow (x + r, x - r, y, colour, filled) ;
 
   while (x1 < y1)
   {
@@ -387,20 +1344,10 @@ void lcd128x64circle (int32 x, int32 y, int32 r, int32 colour, int32 filled)
     x1++ ;
     ddF_x += 2 ;
     f += ddF_x ;
-    if (filled)
-    {
-      lcd128x64line (x + x1, y + y1, x - x1, y + y1, colour) ;
-      lcd128x64line (x + x1, y - y1, x - x1, y - y1, colour) ;
-      lcd128x64line (x + y1, y + x1, x - y1, y + x1, colour) ;
-      lcd128x64line (x + y1, y - x1, x - y1, y - x1, colour) ;
-    }
-    else
-    {
-      lcd128x64point (x + x1, y + y1, colour) ; lcd128x64point (x - x1, y + y1, colour) ;
-      lcd128x64point (x + x1, y - y1, colour) ; lcd128x64point (x - x1, y - y1, colour) ;
-      lcd128x64point (x + y1, y + x1, colour) ; lcd128x64point (x - y1, y + x1, colour) ;
-      lcd128x64point (x + y1, y - x1, colour) ; lcd128x64point (x - y1, y - x1, colour) ;
-    }
+    curveRow (x + x1, x - x1, y + y1, colour, filled) ;
+    curveRow (x + x1, x - x1, y - y1, colour, filled) ;
+    curveRow (x + y1, x - y1, y + x1, colour, filled) ;
+    curveRow (x + y1, x - y1, y - x1, colour, filled) ;
   }
 }
 
@@ -419,18 +1366,8 @@ void lcd128x64circle (int32 x, int32 y, int32 r, int32 colour, int32 filled)
  */
 static void plot4ellipsePoints (int32 cx, int32 cy, int32 x, int32 y, int32 colour, int32 filled)
 {
-  if (filled)
-  {
-    lcd128x64line (cx + x, cy + y, cx - x, cy + y, colour) ;
-    lcd128x64line (cx - x, cy - y, cx + x, cy - y, colour) ;
-  }
-  else
-  {
-    lcd128x64point (cx + x, cy + y, colour) ;
-    lcd128x64point (cx - x, cy + y, colour) ;
-    lcd128x64point (cx - x, cy - y, colour) ;
-    lcd128x64point (cx + x, cy - y, colour) ;
-  }
+  curveRow (cx + x, cx - x, cy + y, colour, filled) ;
+  curveRow (cx + x, cx - x, cy - y, colour, filled) ;
 }
 
 void lcd128x64ellipse (int32 cx, int32 cy, int32 xRadius, int32 yRadius, int32 colour, int32 filled)
@@ -440,6 +1377,21 @@ void lcd128x64ellipse (int32 cx, int32 cy, int32 xRadius, int32 yRadius, int32 c
   int32 twoAsquare, twoBsquare ;
   int32 stoppingX, stoppingY ;
 
+  if (listRecording)
+  {
+    listAdd (CMD_ELLIPSE, colour, filled, 0, cx, cy, xRadius, yRadius,
+             cx - xRadius, cy - yRadius, cx + xRadius, cy + yRadius) ;
+    return ;
+  }
+
+// With a zero radius neither loop below ever ends; it's just a line
+
+  if ((xRadius == 0) || (yRadius == 0))
+  {
+    fillRect (cx - abs (xRadius), cy - abs (yRadius), cx + abs (xRadius), cy + abs (yRadius), colour) ;
+    return ;
+  }
+
   twoAsquare = 2 * xRadius * xRadius ;
   twoBsquare = 2 * yRadius * yRadius ;
 
@@ -507,6 +1459,7 @@ void lcd128x64ellipse (int32 cx, int32 cy, int32 xRadius, int32 yRadius, int32 c
 void lcd128x64putchar (int32 x, int32 y, int32 c, int32 bgCol, int32 fgCol)
 {
   int32 y1, y2 ;
+  int32 penX = lastX, penY = lastY ;
 
   uint8 line ;
   uint8 *fontPtr ;
@@ -516,6 +1469,13 @@ void lcd128x64putchar (int32 x, int32 y, int32 c, int32 bgCol, int32 fgCol)
   if ((x < 0) || (x > (maxX - fontWidth)) || (y < 0) || (y > (maxY - fontHeight)))
     return ;
 
+  if (listRecording)
+  {
+    listAdd (CMD_CHAR, fgCol, bgCol, 1, x, y, c, 0,
+             x, y, x + fontWidth - 1, y + fontHeight - 1) ;
+    return ;
+  }
+
   fontPtr = font + c * fontHeight ;
 
   for (y1 = 0; y1 < fontHeight ; y1++)
@@ -531,6 +1491,11 @@ void lcd128x64putchar (int32 x, int32 y, int32 c, int32 bgCol, int32 fgCol)
     lcd128x64point (x + 6, y2, (line & 0x02) == 0 ? bgCol : fgCol) ;
     lcd128x64point (x + 7, y2, (line & 0x01) == 0 ? bgCol : fgCol) ;
   }
+
+// Like a recorded character, leave lcd128x64lineTo where it was
+
+  lastX = penX ;
+  lastY = penY ;
 }
 
 
@@ -593,22 +1558,518 @@ void lcd128x64putnum (int32 x, int32 y, int32 num, int32 bgCol, int32 fgCol)
  *	Send a picture to the display. 
  *********************************************************************************
  */
-void lcd128x64putbmp (int32 x0, int32 y0, int32 with, int32 height, uint8* bmp, int32 colour)
+static void drawBmp (int32 x0, int32 y0, int32 with, int32 height, const uint8* bmp, int32 colour)
 {
   int32 x=0, y=0;
+  int32 y1 = height/8;
   uint8 data = 0;
-  
-  for(y=y0; y<(height/8); y++)
+
+// Only the pages inside the clip window; it is whole pages when set
+
+  if(y0 < clipY0/8)
+  {
+    bmp += (clipY0/8 - y0) * (with - x0);
+    y0 = clipY0/8;
+  }
+  if(y1 > clipY1/8)
+    y1 = clipY1/8;
+  if((y0 >= y1) || (x0 >= with))
+    return;
+
+  markDirty(x0, with-1, y0, y1-1);
+  for(y=y0; y<y1; y++)
   {
     //setPos(x0, y);
     for(x=x0; x<with; x++)
     {
       data = *bmp++;
-      frameBuffer[x][y] = ((colour != 0) ? data : ~data);
+      FB(x, y) = ((colour != 0) ? data : ~data);
+    }
+  }
+}
+
+void lcd128x64putbmp (int32 x0, int32 y0, int32 with, int32 height, uint8* bmp, int32 colour)
+{
+  if (listRecording)
+  {
+    if (listBmpCount == LIST_BMPS)
+    {
+      lcd128x64listPresent (0) ;
+      lcd128x64listBegin   () ;
+    }
+    listBmps [listBmpCount] = bmp ;
+    listAdd (CMD_BMP, colour, listBmpCount++, 1, x0, y0, with, height,
+             x0, y0 * 8, with - 1, (height / 8) * 8 - 1) ;
+    return ;
+  }
+  drawBmp (x0, y0, with, height, bmp, colour) ;
+}
+
+/*
+ * lcd128x64blit:
+ *	Draw a page-major bitmap (see tools/pbm2c) with its top left corner
+ *	at x,y, replacing the pixels underneath. If the bitmap carries a
+ *	variant pre-shifted for y's position within a page, its bytes are
+ *	only masked into place; otherwise they are shifted on the fly.
+ *********************************************************************************
+ */
+static void drawBlit (int32 x, int32 y, const lcd128x64bitmap *bmp, int32 colour)
+{
+  const uint8 *src ;
+  int32 s, w, page0, page, pages, c, cx, row0, row1, top, bot ;
+  uint8 mask, data, prev ;
+
+  w     = bmp->width ;
+  s     = y & 7 ;
+  page0 = (y - s) / 8 ;
+  pages = (bmp->height + s + 7) / 8 ;
+  src   = bmp->data [s] ;
+
+  row0 = (y > clipY0) ? y : clipY0 ;
+  row1 = (y + bmp->height - 1 < clipY1 - 1) ? (y + bmp->height - 1) : (clipY1 - 1) ;
+  if (row0 > row1)
+    return ;
+
+  for (page = page0 ; page < page0 + pages ; ++page)
+  {
+    top = (page * 8 > row0) ? 0 : (row0 - page * 8) ;
+    bot = (page * 8 + 7 < row1) ? 7 : (row1 - page * 8) ;
+    if (top > bot)
+      continue ;
+    mask = (uint8)((0xFF << top) & (0xFF >> (7 - bot))) ;
+
+    for (c = 0 ; c < w ; ++c)
+    {
+      cx = x + c ;
+      if ((cx < clipX0) || (cx >= clipX1))
+        continue ;
+
+      if (src != NULL)
+        data = src [(page - page0) * w + c] ;
+      else
+      {
+        data = (page - page0 < (bmp->height + 7) / 8) ?
+                 (uint8)(bmp->data [0][(page - page0) * w + c] << s) : 0 ;
+        prev = (page > page0) ? bmp->data [0][(page - page0 - 1) * w + c] : 0 ;
+        data |= (uint8)(prev >> (8 - s)) ;
+      }
+      if (!colour)
+        data = (uint8)~data ;
+
+      FB (cx, page) = (uint8)((FB (cx, page) & ~mask) | (data & mask)) ;
+      MARK (cx, page) ;
+    }
+  }
+}
+
+void lcd128x64blit (int32 x, int32 y, const lcd128x64bitmap *bmp, int32 colour)
+{
+  if ((bmp == NULL) || (bmp->data [0] == NULL))
+    return ;
+
+  if (listRecording)
+  {
+    if (listBmpCount == LIST_BMPS)
+    {
+      lcd128x64listPresent (0) ;
+      lcd128x64listBegin   () ;
     }
+    listBmps [listBmpCount] = bmp ;
+    listAdd (CMD_BLIT, colour, listBmpCount++, 1, x, y, 0, 0,
+             x, y, x + bmp->width - 1, y + bmp->height - 1) ;
+    return ;
   }
+  drawBlit (x, y, bmp, colour) ;
 }
 
+
+/*
+ * lcd128x64putgray:
+ *	Dither a w x h grayscale image (stride bytes per row, 255 lit) to
+ *	x,y with one of the LCD_DITHER_ algorithms. An image on a page
+ *	boundary, a whole number of pages high and inside the clip window
+ *	is dithered straight into the framebuffer; anything else goes
+ *	through a buffer and is blitted. Returns -1 for bad arguments or
+ *	an image larger than 128x128.
+ *********************************************************************************
+ */
+int32 lcd128x64putgray (int32 x, int32 y, int32 w, int32 h, const uint8 *gray, int32 stride, int32 algo)
+{
+  uint8 buf [LCD_WIDTH * LCD_WIDTH / 8] ;
+  lcd128x64bitmap bm ;
+
+  if ((gray == NULL) || (w <= 0) || (h <= 0) || (w > LCD_WIDTH) || (h > LCD_WIDTH))
+    return -1 ;
+
+  if (!listRecording && !(y & 7) && !(h & 7) &&
+      (x >= clipX0) && (y >= clipY0) && (x + w <= clipX1) && (y + h <= clipY1))
+  {
+    if (lcd128x64dither (gray, w, h, stride, algo, &FB (x, y / 8), 1 << fbShift, 1) < 0)
+      return -1 ;
+    markDirty (x, x + w - 1, y / 8, (y + h) / 8 - 1) ;
+    return 0 ;
+  }
+
+  if (lcd128x64dither (gray, w, h, stride, algo, buf, 1, w) < 0)
+    return -1 ;
+
+  memset (&bm, 0, sizeof (bm)) ;
+  bm.width    = w ;
+  bm.height   = h ;
+  bm.data [0] = buf ;
+
+  if (listRecording)
+    lcd128x64listPresent (0) ;
+
+  drawBlit (x, y, &bm, 1) ;
+
+  if (listRecording)
+    lcd128x64listBegin () ;
+
+  return 0 ;
+}
+
+
+/*
+ * lcd128x64save: lcd128x64restore:
+ *	Save the page bytes under a w x h area, and put them back. buf is
+ *	page-major, one byte per column for every page the area touches,
+ *	so it needs LCD_SAVE_SIZE (w, h) bytes. Parts off the screen are
+ *	skipped. Restoring only puts back the rows of the area and marks
+ *	dirty only the bytes that change, so taking down an overlay costs
+ *	a copy and a small flush. Returns the number of bytes used.
+ *********************************************************************************
+ */
+int32 lcd128x64save (int32 x, int32 y, int32 w, int32 h, uint8 *buf)
+{
+  int32 page0, pages, p, c, cx ;
+
+  if ((buf == NULL) || (w <= 0) || (h <= 0))
+    return 0 ;
+
+  if (listRecording)
+  {
+    lcd128x64listPresent (0) ;
+    lcd128x64listBegin   () ;
+  }
+
+  page0 = (y >= 0) ? (y / 8) : -((7 - y) / 8) ;
+  pages = (y + h - 1 - page0 * 8) / 8 + 1 ;
+
+  for (p = 0 ; p < pages ; ++p)
+  {
+    if ((page0 + p < 0) || (page0 + p >= maxY / 8))
+      continue ;
+    for (c = 0 ; c < w ; ++c)
+    {
+      cx = x + c ;
+      if ((cx >= 0) && (cx < maxX))
+        buf [p * w + c] = FB (cx, page0 + p) ;
+    }
+  }
+
+  return pages * w ;
+}
+
+int32 lcd128x64restore (int32 x, int32 y, int32 w, int32 h, const uint8 *buf)
+{
+  int32 page0, pages, p, c, cx, top, bot ;
+  uint8 mask, v ;
+
+  if ((buf == NULL) || (w <= 0) || (h <= 0))
+    return 0 ;
+
+  if (listRecording)
+    lcd128x64listPresent (0) ;
+
+  page0 = (y >= 0) ? (y / 8) : -((7 - y) / 8) ;
+  pages = (y + h - 1 - page0 * 8) / 8 + 1 ;
+
+  for (p = 0 ; p < pages ; ++p)
+  {
+    if ((page0 + p < 0) || (page0 + p >= maxY / 8))
+      continue ;
+
+    top  = (p == 0)         ? (y - page0 * 8) : 0 ;
+    bot  = (p == pages - 1) ? (y + h - 1 - (page0 + p) * 8) : 7 ;
+    mask = (uint8)((0xFF << top) & (0xFF >> (7 - bot))) ;
+
+    for (c = 0 ; c < w ; ++c)
+    {
+      cx = x + c ;
+      if ((cx < 0) || (cx >= maxX))
+        continue ;
+      v = (uint8)((FB (cx, page0 + p) & ~mask) | (buf [p * w + c] & mask)) ;
+      if (v != FB (cx, page0 + p))
+      {
+        FB (cx, page0 + p) = v ;
+        MARK (cx, page0 + p) ;
+      }
+    }
+  }
+
+  if (listRecording)
+    lcd128x64listBegin () ;
+
+  return pages * w ;
+}
+
+
+/*
+ * lcd128x64read:
+ *	Read a w x h area back into buf in the layout lcd128x64blit takes
+ *	for data [0]: (h + 7) / 8 pages of w bytes, the top row of the
+ *	area in bit 0 of the first page. Pixels off the screen read as 0.
+ *********************************************************************************
+ */
+void lcd128x64read (int32 x, int32 y, int32 w, int32 h, uint8 *buf)
+{
+  int32 page0, pages, s, p, c, cx, sp ;
+  uint8 lo, hi ;
+
+  if ((buf == NULL) || (w <= 0) || (h <= 0))
+    return ;
+
+  if (listRecording)
+  {
+    lcd128x64listPresent (0) ;
+    lcd128x64listBegin   () ;
+  }
+
+  page0 = (y >= 0) ? (y / 8) : -((7 - y) / 8) ;
+  s     = y - page0 * 8 ;
+  pages = (h + 7) / 8 ;
+
+  for (p = 0 ; p < pages ; ++p)
+  {
+    sp = page0 + p ;
+    for (c = 0 ; c < w ; ++c)
+    {
+      cx = x + c ;
+      lo = hi = 0 ;
+      if ((cx >= 0) && (cx < maxX))
+      {
+        if ((sp >= 0) && (sp < maxY / 8))
+          lo = FB (cx, sp) ;
+        if (s && (sp + 1 >= 0) && (sp + 1 < maxY / 8))
+          hi = FB (cx, sp + 1) ;
+      }
+      buf [p * w + c] = s ? (uint8)((lo >> s) | (hi << (8 - s))) : lo ;
+    }
+  }
+
+  if (h & 7)
+    for (c = 0 ; c < w ; ++c)
+      buf [(pages - 1) * w + c] &= (uint8)(0xFF >> (8 - (h & 7))) ;
+}
+
+
+/*
+ * unpack:
+ *	Decode a packed bitmap (see lcd128x64.h) straight into its page-major
+ *	destination: output byte k lands in column k % width, page k / width,
+ *	at dst + column * colStride + page * pageStride. Back-references read
+ *	the bytes already written there, so no other buffer is needed. With
+ *	track set, only bytes that change are stored and marked dirty.
+ *	When h isn't a multiple of 8 only the low h & 7 bits of the last
+ *	page are the bitmap's: with track set the rest of each byte keeps
+ *	what was there, otherwise it is cleared.
+ *********************************************************************************
+ */
+static int32 unpack (const uint8 *src, int32 srcLen, uint8 *dst, int32 colStride, int32 pageStride,
+                     int32 w, int32 h, uint8 inv, int32 x0, int32 page0, int32 track)
+{
+  const uint8 *end = src + srcLen ;
+  int32 total = w * ((h + 7) / 8) ;
+  int32 lastPage = (h & 7) ? (h - 1) / 8 : -1 ;
+  int32 pos = 0, col = 0, page = 0, sc = 0, sp = 0, n, d, kind ;
+  uint8 last = (uint8)((1 << (h & 7)) - 1) ;
+  uint8 op, b = 0, v, *out ;
+
+  while (pos < total)
+  {
+    if (src >= end)
+      return -1 ;
+
+    op = *src++ ;
+    if (op < 0x80)
+    {
+      kind = 0 ;
+      n    = op + 1 ;
+      if (src + n > end)
+        return -1 ;
+    }
+    else
+    {
+      if (src >= end)
+        return -1 ;
+      if (op < 0xC0)
+      {
+        kind = 1 ;
+        n    = op - 0x80 + 3 ;
+        b    = (uint8)(*src++ ^ inv) ;
+      }
+      else
+      {
+        kind = 2 ;
+        n    = op - 0xC0 + 3 ;
+        d    = *src++ + 1 ;
+        if (d > pos)
+          return -1 ;
+        sc = (pos - d) % w ;
+        sp = (pos - d) / w ;
+      }
+    }
+
+    if (pos + n > total)
+      return -1 ;
+    pos += n ;
+
+    while (n--)
+    {
+      if (kind == 0)
+        b = (uint8)(*src++ ^ inv) ;
+      else if (kind == 2)
+      {
+        b = dst [sc * colStride + sp * pageStride] ;
+        if (++sc == w)
+        {
+          sc = 0 ;
+          ++sp ;
+        }
+      }
+
+      out = dst + col * colStride + page * pageStride ;
+      v   = b ;
+      if (page == lastPage)
+        v = track ? (uint8)((*out & ~last) | (b & last)) : (uint8)(b & last) ;
+
+      if (!track)
+        *out = v ;
+      else if (*out != v)
+      {
+        *out = v ;
+        MARK (x0 + col, page0 + page) ;
+      }
+
+      if (++col == w)
+      {
+        col = 0 ;
+        ++page ;
+      }
+    }
+  }
+
+  return 0 ;
+}
+
+
+/*
+ * lcd128x64putpacked:
+ *	Decode a packed bitmap into the framebuffer at x,y. y must be a
+ *	multiple of 8 and the bitmap must lie wholly on the screen; place
+ *	it anywhere else by unpacking into a buffer and using
+ *	lcd128x64blit. Rows below the bitmap in its last page are left
+ *	alone, and only the bytes that change are marked dirty.
+ *	Returns -1 if it can't be placed or the data is corrupt.
+ *********************************************************************************
+ */
+int32 lcd128x64putpacked (int32 x, int32 y, const lcd128x64packed *img, int32 colour)
+{
+  if ((img == NULL) || (y & 7) || (x < 0) || (y < 0) ||
+      (x + img->width > maxX) || (y + img->height > ((maxY + 7) & ~7)))
+    return -1 ;
+
+  if (listRecording)
+    lcd128x64listPresent (0) ;
+
+  colour = unpack (img->data, img->size, &FB (x, y / 8), 1 << fbShift, 1,
+                   img->width, img->height, colour ? 0x00 : 0xFF, x, y / 8, 1) ;
+
+  if (listRecording)
+    lcd128x64listBegin () ;
+
+  return colour ;
+}
+
+
+/*
+ * lcd128x64unpack:
+ *	Decode a packed bitmap into a page-major buffer of width * pages
+ *	bytes, the layout lcd128x64bitmap uses for data [0].
+ *********************************************************************************
+ */
+int32 lcd128x64unpack (const lcd128x64packed *img, uint8 *buf)
+{
+  if ((img == NULL) || (buf == NULL))
+    return -1 ;
+
+  return unpack (img->data, img->size, buf, 1, img->width,
+                 img->width, img->height, 0x00, 0, 0, 0) ;
+}
+
+
+/*
+ * lcd128x64putdelta:
+ *	XOR a delta into the w x h area at x,y, laid out page-major like a
+ *	packed bitmap. A delta is a sequence of (skip, count) varint pairs
+ *	each followed by count bytes to XOR in, so unchanged bytes cost
+ *	nothing and only the bytes that change are marked dirty. Decoding
+ *	is lcd128x64deltaRuns, shared with the tools. The same placement
+ *	rules as lcd128x64putpacked apply. Returns -1 if it can't be
+ *	placed or the delta runs past the area.
+ *********************************************************************************
+ */
+struct deltaArea
+{
+  int32 x, page, w ;
+} ;
+
+static void xorRunFB (int32 pos, const uint8 *bytes, int32 n, void *arg)
+{
+  const struct deltaArea *a = arg ;
+  int32 col = pos % a->w, page = a->page + pos / a->w ;
+  uint8 v ;
+
+  while (n--)
+  {
+    if ((v = *bytes++) != 0)
+    {
+      FB (a->x + col, page) ^= v ;
+      MARK (a->x + col, page) ;
+    }
+    if (++col == a->w)
+    {
+      col = 0 ;
+      ++page ;
+    }
+  }
+}
+
+int32 lcd128x64putdelta (int32 x, int32 y, int32 w, int32 h, const uint8 *delta, int32 size)
+{
+  struct deltaArea area ;
+  int32 ret ;
+
+  if ((delta == NULL) || (y & 7) || (x < 0) || (y < 0) || (w <= 0) ||
+      (x + w > maxX) || (y + h > ((maxY + 7) & ~7)))
+    return -1 ;
+
+  if (listRecording)
+    lcd128x64listPresent (0) ;
+
+  area.x    = x ;
+  area.page = y / 8 ;
+  area.w    = w ;
+  ret = lcd128x64deltaRuns (delta, size, w * ((h + 7) / 8), xorRunFB, &area) ;
+
+  if (listRecording)
+    lcd128x64listBegin () ;
+
+  return ret ;
+}
+
+
 /*
  * lcd128x64putbmpspeed:
  *	Send a picture to the display. 
@@ -667,14 +2128,16 @@ void lcd128x64hardwareClear(void)
   int32 i,n;		    
   for(i=0;i<8;i++)  
   {  
-    sendData(0xb0+i, OLED_CMD);
-    sendData(0x02, OLED_CMD);
-    sendData(0x10, OLED_CMD);   
+    setPos(0, i);
     for(n=0; n<128; n++)
     {
       sendData(0,OLED_DATA);
     }
+    frameLo [i] = 0 ;
+    frameHi [i] = LCD_WIDTH - 1 ;
   }
+  memset (panel, 0, sizeof (panel)) ;
+  endFrame () ;
 }
 
 
@@ -686,44 +2149,254 @@ void lcd128x64hardwareClear(void)
 
 void lcd128x64clear (int32 colour)
 {
-  int32 x=0, y=0;
-  int32 col = 0;
-  
-  if(colour)
-    col = 0xff;
-  else
-    col = 0x00;
+  if (listRecording)
+  {
+    listAdd (CMD_CLEAR, colour, 0, 1, 0, 0, 0, 0, 0, 0, maxX - 1, maxY - 1) ;
+    return ;
+  }
+  memset (frameBuffer, colour ? 0xff : 0x00, sizeof (frameBuffer)) ;
+  markDirty (0, maxX - 1, 0, maxY / 8 - 1) ;
+}
 
-  for(y=0; y<(LCD_HEIGHT); y++)
+
+/*
+ *********************************************************************************
+ * Display list
+ *********************************************************************************
+ */
+
+
+/*
+ * listAdd:
+ *	Record one primitive with its bounding box. Commands entirely off
+ *	the screen are dropped here; when the list is full the recorded
+ *	commands are rasterized so recording can carry on.
+ *********************************************************************************
+ */
+static void listAdd (int32 op, int32 colour, int32 arg, int32 cover,
+                     int32 a, int32 b, int32 c, int32 d,
+                     int32 x0, int32 y0, int32 x1, int32 y1)
+{
+  struct listCmd *cmd ;
+
+  switch (op)
+  {
+    case CMD_POINT:   listLastX = a ; listLastY = b ; break ;
+    case CMD_LINE:    listLastX = c ; listLastY = d ; break ;
+    case CMD_RECT:    listLastX = arg ? (a > c ? a : c) : a ;
+                      listLastY = arg ? d : b ; break ;
+    default:          break ;
+  }
+
+  if ((x1 < 0) || (x0 >= maxX) || (y1 < 0) || (y0 >= maxY))
+    return ;
+
+  if (listCount == LIST_SIZE)
+  {
+    lcd128x64listPresent (0) ;
+    lcd128x64listBegin   () ;
+  }
+
+  cmd = &listCmds [listCount++] ;
+  cmd->op     = (uint8)op ;
+  cmd->colour = (uint8)colour ;
+  cmd->arg    = (uint8)arg ;
+  cmd->cover  = (uint8)cover ;
+  cmd->v [0]  = (short)a ; cmd->v [1] = (short)b ;
+  cmd->v [2]  = (short)c ; cmd->v [3] = (short)d ;
+  cmd->bx0    = (short)(x0 < 0 ? 0 : x0) ;
+  cmd->by0    = (short)(y0 < 0 ? 0 : y0) ;
+  cmd->bx1    = (short)(x1 >= maxX ? maxX - 1 : x1) ;
+  cmd->by1    = (short)(y1 >= maxY ? maxY - 1 : y1) ;
+}
+
+
+/*
+ * listCull:
+ *	Walk the list backwards, dropping every command whose bounds are
+ *	wholly inside the bounds of a later command that overwrites all of
+ *	its pixels. Only the largest few covering rectangles are kept.
+ *	Returns the number of commands left, compacted in order.
+ *********************************************************************************
+ */
+#define LIST_COVERS   8
+
+static int32 listCull (void)
+{
+  short covers [LIST_COVERS][4] ;
+  int32 nCovers = 0, i, j, n, small ;
+  int32 keep [LIST_SIZE] ;
+  struct listCmd *cmd ;
+
+  for (i = listCount - 1 ; i >= 0 ; --i)
   {
-    for(x=0; x<LCD_WIDTH; x++)
+    cmd = &listCmds [i] ;
+    keep [i] = 1 ;
+    for (j = 0 ; j < nCovers ; ++j)
+    {
+      if ((cmd->bx0 >= covers [j][0]) && (cmd->by0 >= covers [j][1]) &&
+          (cmd->bx1 <= covers [j][2]) && (cmd->by1 <= covers [j][3]))
+      {
+        keep [i] = 0 ;
+        break ;
+      }
+    }
+    if (!keep [i] || !cmd->cover)
+      continue ;
+
+    if (nCovers < LIST_COVERS)
+      j = nCovers++ ;
+    else
     {
-      frameBuffer[x][y] = col;
+      small = 0 ;
+      for (j = 1 ; j < LIST_COVERS ; ++j)
+        if ((covers [j][2] - covers [j][0] + 1) * (covers [j][3] - covers [j][1] + 1) <
+            (covers [small][2] - covers [small][0] + 1) * (covers [small][3] - covers [small][1] + 1))
+          small = j ;
+      if ((cmd->bx1 - cmd->bx0 + 1) * (cmd->by1 - cmd->by0 + 1) <=
+          (covers [small][2] - covers [small][0] + 1) * (covers [small][3] - covers [small][1] + 1))
+        continue ;
+      j = small ;
     }
+    covers [j][0] = cmd->bx0 ; covers [j][1] = cmd->by0 ;
+    covers [j][2] = cmd->bx1 ; covers [j][3] = cmd->by1 ;
+  }
+
+  for (i = 0, n = 0 ; i < listCount ; ++i)
+    if (keep [i])
+      listCmds [n++] = listCmds [i] ;
+
+  return n ;
+}
+
+
+/*
+ * listDraw:
+ *	Rasterize a single recorded command within the clip window.
+ *********************************************************************************
+ */
+static void listDraw (const struct listCmd *cmd)
+{
+  const short *v = cmd->v ;
+
+  switch (cmd->op)
+  {
+    case CMD_POINT:   lcd128x64point     (v [0], v [1], cmd->colour) ; break ;
+    case CMD_LINE:    lcd128x64line      (v [0], v [1], v [2], v [3], cmd->colour) ; break ;
+    case CMD_RECT:    lcd128x64rectangle (v [0], v [1], v [2], v [3], cmd->colour, cmd->arg) ; break ;
+    case CMD_CIRCLE:  lcd128x64circle    (v [0], v [1], v [2], cmd->colour, cmd->arg) ; break ;
+    case CMD_ELLIPSE: lcd128x64ellipse   (v [0], v [1], v [2], v [3], cmd->colour, cmd->arg) ; break ;
+    case CMD_CHAR:    lcd128x64putchar   (v [0], v [1], v [2], cmd->arg, cmd->colour) ; break ;
+    case CMD_BMP:     drawBmp  (v [0], v [1], v [2], v [3], listBmps [cmd->arg], cmd->colour) ; break ;
+    case CMD_BLIT:    drawBlit (v [0], v [1], listBmps [cmd->arg], cmd->colour) ; break ;
+    case CMD_CLEAR:   fillRect (0, 0, maxX - 1, maxY - 1, cmd->colour) ; break ;
+    default:          break ;
   }
 }
 
 
 /*
- * lcd128x64setup:
- *	Initialise the display and GPIO.
+ * lcd128x64listBegin:
+ *	Start recording primitives into the display list instead of drawing
+ *	them. Until lcd128x64listPresent, reads such as lcd128x64getpoint
+ *	see the framebuffer as it was before recording started, bitmaps
+ *	passed to lcd128x64putbmp must stay valid, and lcd128x64lineTo
+ *	continues from the last point, line or rectangle recorded.
+ *********************************************************************************
+ */
+void lcd128x64listBegin (void)
+{
+  listCount     = 0 ;
+  listBmpCount  = 0 ;
+  listLastX     = lastX ;
+  listLastY     = lastY ;
+  listRecording = 1 ;
+}
+
+
+/*
+ * lcd128x64listPresent:
+ *	Stop recording and draw the display list. Overdrawn commands are
+ *	culled and the rest bucketed by the pages their bounds touch, then
+ *	the framebuffer is rasterized one page at a time, each page drawing
+ *	only its own bucket, in the order the commands were recorded, and
+ *	lines and curves only their rows in that page. If flush is set the
+ *	changed part of each page is sent to the display as soon as it is
+ *	finished; in portrait mode every panel page depends on every
+ *	framebuffer page, so the flush is done once at the end.
  *********************************************************************************
  */
-int32 lcd128x64setup (void)
+void lcd128x64listPresent (int32 flush)
 {
-  wiringPiSetup();
-  pinMode(OLED_SCL, OUTPUT);
-  pinMode(OLED_SDIN, OUTPUT);
-  pinMode(OLED_RST, OUTPUT);
-  pinMode(OLED_DC, OUTPUT);
-  pinMode(OLED_CS, OUTPUT);
+  int32 start [FB_PAGES + 1], next [FB_PAGES] ;
+  int32 n, i, page, pages ;
+
+  if (!listRecording)
+    return ;
+  listRecording = 0 ;
+
+  n     = listCull () ;
+  pages = maxY / 8 ;
+
+// Count the commands on each page, then place them in order
 
-  OLED_RST_Set();
-  delay_ms(100);
-  OLED_RST_Clr();
-  delay_ms(100);
-  OLED_RST_Set(); 
+  for (page = 0 ; page <= pages ; ++page)
+    start [page] = 0 ;
+  for (i = 0 ; i < n ; ++i)
+    for (page = listCmds [i].by0 / 8 ; page <= listCmds [i].by1 / 8 ; ++page)
+      ++start [page + 1] ;
+  for (page = 0 ; page < pages ; ++page)
+  {
+    start [page + 1] += start [page] ;
+    next  [page]      = start [page] ;
+  }
+  for (i = 0 ; i < n ; ++i)
+    for (page = listCmds [i].by0 / 8 ; page <= listCmds [i].by1 / 8 ; ++page)
+      listPage [next [page]++] = (uint8)i ;
+
+  for (page = 0 ; page < pages ; ++page)
+  {
+    clipY0 = page * 8 ;
+    clipY1 = clipY0 + 8 ;
+    for (i = start [page] ; i < start [page + 1] ; ++i)
+      listDraw (&listCmds [listPage [i]]) ;
+
+    if (flush && (rotation == 0) && (dirtyLo [page] <= dirtyHi [page]))
+    {
+      if (swMirrorX)
+        sendPage (swMirrorY ? (LCD_HEIGHT - 1 - page) : page,
+                  LCD_WIDTH - 1 - dirtyHi [page], LCD_WIDTH - 1 - dirtyLo [page]) ;
+      else
+        sendPage (swMirrorY ? (LCD_HEIGHT - 1 - page) : page,
+                  dirtyLo [page], dirtyHi [page]) ;
+      dirtyLo [page] = LCD_WIDTH ;
+      dirtyHi [page] = -1 ;
+    }
+  }
+  clipY0 = 0 ;
+  clipY1 = maxY ;
+
+  if (flush && (rotation != 0))
+    lcd128x64flush () ;
+  else if (flush)
+    endFrame () ;
+
+  listCount    = 0 ;
+  listBmpCount = 0 ;
+  lastX        = listLastX ;
+  lastY        = listLastY ;
+}
 
+
+/*
+ * lcd128x64init:
+ *	Initialise the controller through the current transport, once it
+ *	is out of reset, and start with a clear screen in the normal
+ *	orientation.
+ *********************************************************************************
+ */
+int32 lcd128x64init (void)
+{
   sendData(0xAE,OLED_CMD);//--turn off oled panel
   sendData(0x02,OLED_CMD);//---set low column address
   sendData(0x10,OLED_CMD);//---set high column address
@@ -755,6 +2428,7 @@ int32 lcd128x64setup (void)
 
   sendData(0xAF,OLED_CMD); /*display ON*/ 
   setPos(0,0);
+  clearDirty();
   
   lcd128x64open           () ;
   lcd128x64setOrientation (0) ;
@@ -25,6 +25,7 @@
  
 #define uint8   unsigned char
 #define uint32  unsigned int
+#define uint64  unsigned long long
 #define int8   	char
 #define int32  	int
 
@@ -32,8 +33,96 @@
 #define	LCD_WIDTH     128
 #define	LCD_HEIGHT    8
 
+// Batch primitives
+typedef struct lcd128x64pt
+{
+  short x, y ;
+} lcd128x64pt ;
+
+typedef lcd128x64pt lcd128x64cell ;
+
+// A horizontal run of row y from x0 to x1 inclusive
+typedef struct lcd128x64hspan
+{
+  short x0, x1, y ;
+} lcd128x64hspan ;
+
+// Page-major bitmaps, as generated by tools/pbm2c. data [0] holds
+//	(height + 7) / 8 pages of width bytes; data [s], if not NULL, is
+//	the same image shifted s rows down, for drawing at y % 8 == s.
+typedef struct lcd128x64bitmap
+{
+  int32        width, height ;
+  const uint8 *data [8] ;
+} lcd128x64bitmap ;
+
+// Packed bitmaps: a page-major byte stream (page by page, one byte
+//	per column) compressed as a sequence of
+//	  0x00-0x7F n       n+1 literal bytes follow
+//	  0x80-0xBF n, b    byte b repeated n-0x80+3 times
+//	  0xC0-0xFF n, d    copy n-0xC0+3 bytes from d+1 bytes back
+typedef struct lcd128x64packed
+{
+  int32        width, height ;
+  int32        size ;
+  const uint8 *data ;
+} lcd128x64packed ;
+
+// Largest lcd128x64pack output for len bytes
+#define	LCD_MAX_PACKED(len)   ((len) + (len) / 128 + 1)
+
+// The lcd128x64cellN function for a cell size known at compile time,
+//	which must be a literal 1, 2, 4 or 8 or a macro expanding to one
+#define	LCD_CELL_FN(size)     LCD_CELL_FN_(size)
+#define	LCD_CELL_FN_(size)    lcd128x64cell ## size
+
+// Bytes lcd128x64save needs for a w x h area, wherever it lies
+#define	LCD_SAVE_SIZE(w,h)    ((w) * (((h) + 14) / 8))
+
+// Transports: how bytes reach the controller. data may be handed a
+//	whole page span at once. hwRemap says whether the controller's
+//	SEG/COM remap registers take effect; if not, mirroring is done in
+//	software. present, if not NULL, is called at the end of every
+//	update or flush.
+typedef struct lcd128x64transport
+{
+  void  (*command) (uint8 c) ;
+  void  (*data)    (const uint8 *buf, int32 len) ;
+  int32 hwRemap ;
+  void  (*present) (void) ;
+} lcd128x64transport ;
+
+// Frames as handed to frame hooks: panel is what the panel shows,
+//	LCD_HEIGHT pages of LCD_WIDTH bytes, bit 0 the top row of a page,
+//	whatever the orientation and remapping. lo [p] .. hi [p] are the
+//	columns of page p sent in this frame, lo > hi if none.
+typedef struct lcd128x64frame
+{
+  const uint8 *panel ;
+  int32        lo [LCD_HEIGHT], hi [LCD_HEIGHT] ;
+  uint32       number ;
+} lcd128x64frame ;
+
+typedef void (*lcd128x64frameHook) (const lcd128x64frame *frame, void *arg) ;
+
+// Dithering algorithms for lcd128x64putgray
+#define	LCD_DITHER_BAYER      0
+#define	LCD_DITHER_FLOYD      1
+#define	LCD_DITHER_ATKINSON   2
+
+// Orientations
+#define	LCD_NORMAL    0
+#define	LCD_MIRROR_X  1
+#define	LCD_MIRROR_Y  2
+#define	LCD_MIRROR_XY 3
+#define	LCD_ROTATE90  4
+#define	LCD_ROTATE270 5
+
 extern void   lcd128x64getScreenSize     (int32 *x, int32 *y) ;
 extern void   lcd128x64setOrientation    (int32 orientation) ;
+extern void   lcd128x64setHardwareRemap  (int32 enable) ;
+extern void   lcd128x64setTransport      (const lcd128x64transport *t) ;
+extern uint32 lcd128x64bytesSent         (void) ;
 extern void   lcd128x64point             (int32  x, int32  y, int32 colour) ;
 extern int32  lcd128x64getpoint          (int32 x, int32 y) ;
 extern void   lcd128x64line              (int32 x0, int32 y0, \
@@ -42,6 +131,17 @@ extern void   lcd128x64lineTo            (int32  x, int32  y, int32 colour) ;
 extern void   lcd128x64rectangle         (int32 x1, int32 y1, \
                                             int32 x2, int32 y2, int32 colour, \
                                             int32 filled) ;
+extern void   lcd128x64points            (const lcd128x64pt *pts, int32 n, \
+                                            int32 colour) ;
+extern void   lcd128x64cells             (const lcd128x64cell *cells, int32 n, \
+                                            int32 cellSize, int32 colour) ;
+extern void   lcd128x64spans             (const lcd128x64hspan *spans, int32 n, \
+                                            int32 colour) ;
+extern void   lcd128x64cell1             (int32 cx, int32 cy, int32 colour) ;
+extern void   lcd128x64cell2             (int32 cx, int32 cy, int32 colour) ;
+extern void   lcd128x64cell4             (int32 cx, int32 cy, int32 colour) ;
+extern void   lcd128x64cell8             (int32 cx, int32 cy, int32 colour) ;
+extern int32  lcd128x64floodfill         (int32  x, int32  y, int32 colour) ;
 extern void   lcd128x64circle            (int32  x, int32  y, int32  r, \
                                             int32 colour, int32 filled) ;
 extern void   lcd128x64ellipse           (int32 cx, int32 cy, int32 xRadius, \
@@ -60,12 +160,54 @@ extern void   lcd128x64putbmp            (int32 x0, int32 y0, int32 with, \
 extern void   lcd128x64putbmpspeed       (int32 x0, int32 y0, int32 with, \
                                             int32 height, uint8* bmp, \
                                             int32 colour) ;
+extern void   lcd128x64blit              (int32  x, int32  y, \
+                                            const lcd128x64bitmap *bmp, \
+                                            int32 colour) ;
+extern int32  lcd128x64save              (int32  x, int32  y, int32 w, \
+                                            int32  h, uint8 *buf) ;
+extern int32  lcd128x64restore           (int32  x, int32  y, int32 w, \
+                                            int32  h, const uint8 *buf) ;
+extern void   lcd128x64read              (int32  x, int32  y, int32 w, \
+                                            int32  h, uint8 *buf) ;
+extern int32  lcd128x64putpacked         (int32  x, int32  y, \
+                                            const lcd128x64packed *img, \
+                                            int32 colour) ;
+extern int32  lcd128x64unpack            (const lcd128x64packed *img, \
+                                            uint8 *buf) ;
+extern int32  lcd128x64pack              (const uint8 *in, int32 len, \
+                                            uint8 *out) ;
+extern int32  lcd128x64putgray           (int32  x, int32  y, int32 w, \
+                                            int32  h, const uint8 *gray, \
+                                            int32 stride, int32 algo) ;
+extern int32  lcd128x64dither            (const uint8 *gray, int32 w, int32 h, \
+                                            int32 stride, int32 algo, uint8 *out, \
+                                            int32 colStride, int32 pageStride) ;
+extern int32  lcd128x64putdelta          (int32  x, int32  y, int32 w, \
+                                            int32  h, const uint8 *delta, \
+                                            int32 size) ;
 extern void   lcd128x64update            (void) ;
+extern void   lcd128x64flush             (void) ;
+extern int32  lcd128x64addFrameHook      (lcd128x64frameHook hook, void *arg) ;
+extern void   lcd128x64removeFrameHook   (lcd128x64frameHook hook, void *arg) ;
 extern void   lcd128x64open              (void) ;
 extern void   lcd128x64cloase            (void) ;
 extern void   lcd128x64hardwareClear     (void) ;
 extern void   lcd128x64clear             (int32 colour) ;
 
+extern void   lcd128x64listBegin         (void) ;
+extern void   lcd128x64listPresent       (int32 flush) ;
+
+extern int32  lcd128x64init              (void) ;
+
+// Transports
+extern const lcd128x64transport lcd128x64spiTransport ;
+extern const lcd128x64transport lcd128x64spiHwTransport ;
+extern const lcd128x64transport lcd128x64termTransport ;
+
 extern int32  lcd128x64setup             (void) ;
+extern int32  lcd128x64setupHw           (int32 channel, int32 speed) ;
+extern int32  lcd128x64termSetup         (void) ;
+extern void   lcd128x64termStatus        (const char *text) ;
+extern uint32 lcd128x64termBytes         (void) ;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,245 @@
+/*
+ * lcd128x64delta.c:
+ *	XOR/RLE frame deltas for the video format in lcd128x64video.h,
+ *	and the encoder for packed bitmaps. Nothing here touches the
+ *	display, so tools can link it on the host.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+
+#include "lcd128x64video.h"
+
+// Unchanged bytes shorter than this between two changes are sent as
+//	zeros rather than starting a new run; a run costs at least 2.
+#define MIN_GAP   3
+
+
+/*
+ * putVarint: getVarint:
+ *	Unsigned LEB128 numbers, 7 bits per byte, low bits first.
+ *********************************************************************************
+ */
+static int32 putVarint (uint8 *out, uint32 v)
+{
+  int32 n = 0 ;
+
+  while (v >= 0x80)
+  {
+    out [n++] = (uint8)(v | 0x80) ;
+    v >>= 7 ;
+  }
+  out [n++] = (uint8)v ;
+  return n ;
+}
+
+static int32 getVarint (const uint8 **src, const uint8 *end, int32 *value)
+{
+  int32 v = 0, shift = 0 ;
+  uint8 b ;
+
+  do
+  {
+    if ((*src >= end) || (shift > 28))
+      return -1 ;
+    b      = *(*src)++ ;
+    v     |= (int32)(b & 0x7F) << shift ;
+    shift += 7 ;
+  } while (b & 0x80) ;
+
+  *value = v ;
+  return 0 ;
+}
+
+
+/*
+ * lcd128x64deltaEncode:
+ *	Encode the change from prev to cur, both len bytes, into out,
+ *	which must hold LVID_MAX_DELTA (len) bytes. A NULL prev stands for
+ *	a blank frame, which makes a keyframe. Returns the delta size; 0
+ *	means nothing changed.
+ *********************************************************************************
+ */
+int32 lcd128x64deltaEncode (const uint8 *prev, const uint8 *cur, int32 len, uint8 *out)
+{
+  int32 pos = 0, n = 0, i, j, k ;
+
+#define CHANGED(i)  (prev ? (prev [i] != cur [i]) : (cur [i] != 0))
+
+  for (i = 0 ; i < len ; )
+  {
+    if (!CHANGED (i))
+    {
+      ++i ;
+      continue ;
+    }
+
+    for (j = i + 1 ; j < len ; ++j)
+    {
+      if (CHANGED (j))
+        continue ;
+      for (k = j ; (k < len) && (k - j < MIN_GAP) && !CHANGED (k) ; ++k)
+        ;
+      if ((k == len) || (k - j == MIN_GAP))
+        break ;
+      j = k ;
+    }
+
+    n += putVarint (out + n, (uint32)(i - pos)) ;
+    n += putVarint (out + n, (uint32)(j - i)) ;
+    for (k = i ; k < j ; ++k)
+      out [n++] = prev ? (uint8)(prev [k] ^ cur [k]) : cur [k] ;
+
+    pos = i = j ;
+  }
+
+#undef CHANGED
+
+  return n ;
+}
+
+
+/*
+ * lcd128x64deltaRuns:
+ *	Decode a delta for a frame of len bytes, handing each run of
+ *	changed bytes to fn in order. This is the one decoder; how the
+ *	bytes are XORed in is up to fn. Returns -1 if the delta is corrupt
+ *	or runs past the frame, after the runs before the fault.
+ *********************************************************************************
+ */
+int32 lcd128x64deltaRuns (const uint8 *delta, int32 size, int32 len,
+  lcd128x64deltaRunFn fn, void *arg)
+{
+  const uint8 *end = delta + size ;
+  int32 pos = 0, skip, n ;
+
+  if ((delta == NULL) || (fn == NULL))
+    return -1 ;
+
+  while (delta < end)
+  {
+    if ((getVarint (&delta, end, &skip) < 0) || (getVarint (&delta, end, &n) < 0) ||
+        (skip > len - pos) || (n > len - pos - skip) || (n > end - delta))
+      return -1 ;
+
+    pos += skip ;
+    fn (pos, delta, n, arg) ;
+    pos   += n ;
+    delta += n ;
+  }
+
+  return 0 ;
+}
+
+
+/*
+ * lcd128x64deltaApply:
+ *	XOR a delta into a buffer of len bytes. Returns -1 if the delta
+ *	is corrupt or runs past the buffer.
+ *********************************************************************************
+ */
+static void xorRun (int32 pos, const uint8 *bytes, int32 n, void *arg)
+{
+  uint8 *buf = (uint8 *)arg + pos ;
+
+  while (n--)
+    *buf++ ^= *bytes++ ;
+}
+
+int32 lcd128x64deltaApply (uint8 *buf, int32 len, const uint8 *delta, int32 size)
+{
+  return lcd128x64deltaRuns (delta, size, len, xorRun, buf) ;
+}
+
+
+/*
+ * lcd128x64pack:
+ *	Compress page-major bytes into the lcd128x64packed format: at each
+ *	position take the longer of a repeated byte or a match within the
+ *	last 256 bytes, if it is at least 3 long; otherwise grow a literal.
+ *	Greedy, but the decoder neither knows nor cares. out must hold
+ *	LCD_MAX_PACKED (len) bytes. Returns the packed size.
+ *********************************************************************************
+ */
+int32 lcd128x64pack (const uint8 *in, int32 len, uint8 *out)
+{
+  int32 pos = 0, n = 0, lit = 0, litStart = 0 ;
+  int32 run, best, bestD, d, m, i ;
+
+  while (pos < len)
+  {
+    for (run = 1 ; (pos + run < len) && (run < 66) && (in [pos + run] == in [pos]) ; ++run)
+      ;
+
+    best = bestD = 0 ;
+    for (d = 1 ; (d <= 256) && (d <= pos) ; ++d)
+    {
+      for (m = 0 ; (pos + m < len) && (m < 66) && (in [pos + m] == in [pos + m - d]) ; ++m)
+        ;
+      if (m > best)
+      {
+        best  = m ;
+        bestD = d ;
+      }
+    }
+
+    if ((run < 3) && (best < 3))
+    {
+      if (lit == 0)
+        litStart = pos ;
+      ++pos ;
+      if (++lit < 128)
+        continue ;
+    }
+
+    if (lit > 0)
+    {
+      out [n++] = (uint8)(lit - 1) ;
+      for (i = 0 ; i < lit ; ++i)
+        out [n++] = in [litStart + i] ;
+      lit = 0 ;
+      if ((run < 3) && (best < 3))
+        continue ;
+    }
+
+    if (run >= best)
+    {
+      out [n++] = (uint8)(0x80 + run - 3) ;
+      out [n++] = in [pos] ;
+      pos += run ;
+    }
+    else
+    {
+      out [n++] = (uint8)(0xC0 + best - 3) ;
+      out [n++] = (uint8)(bestD - 1) ;
+      pos += best ;
+    }
+  }
+
+  if (lit > 0)
+  {
+    out [n++] = (uint8)(lit - 1) ;
+    for (i = 0 ; i < lit ; ++i)
+      out [n++] = in [litStart + i] ;
+  }
+
+  return n ;
+}
@@ -0,0 +1,202 @@
+/*
+ * lcd128x64dither.c:
+ *	Dither 8-bit grayscale down to 1-bit page-major bytes, one strip
+ *	of 8 rows (a page) at a time: the rows of a strip are thresholded
+ *	into a line of column bytes, which is then stored as one page.
+ *	The ordered (Bayer) kernel works on 16 columns at a time with
+ *	SSE2 where available; the error diffusion kernels carry their
+ *	error from row to row and so go one pixel at a time.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "lcd128x64.h"
+
+#define DITHER_MAX_WIDTH  256
+
+// 8x8 Bayer thresholds, (index * 4 + 2), two periods per row so a
+//	16 byte load covers 16 columns.
+static const uint8 bayer [8][16] =
+{
+  {   2, 130,  34, 162,  10, 138,  42, 170,   2, 130,  34, 162,  10, 138,  42, 170 },
+  { 194,  66, 226,  98, 202,  74, 234, 106, 194,  66, 226,  98, 202,  74, 234, 106 },
+  {  50, 178,  18, 146,  58, 186,  26, 154,  50, 178,  18, 146,  58, 186,  26, 154 },
+  { 242, 114, 210,  82, 250, 122, 218,  90, 242, 114, 210,  82, 250, 122, 218,  90 },
+  {  14, 142,  46, 174,   6, 134,  38, 166,  14, 142,  46, 174,   6, 134,  38, 166 },
+  { 206,  78, 238, 110, 198,  70, 230, 102, 206,  78, 238, 110, 198,  70, 230, 102 },
+  {  62, 190,  30, 158,  54, 182,  22, 150,  62, 190,  30, 158,  54, 182,  22, 150 },
+  { 254, 126, 222,  94, 246, 118, 214,  86, 254, 126, 222,  94, 246, 118, 214,  86 },
+} ;
+
+
+/*
+ * bayerStrip:
+ *	Threshold rows of a strip against the Bayer matrix, setting bit r
+ *	of acc [x] for every lit pixel of row r.
+ *********************************************************************************
+ */
+static void bayerStrip (uint8 *acc, const uint8 *gray, int32 w, int32 rows, int32 stride)
+{
+  const uint8 *src ;
+  int32 r, x ;
+  uint8 bit ;
+
+  for (r = 0 ; r < rows ; ++r)
+  {
+    src = gray + r * stride ;
+    bit = (uint8)(1 << r) ;
+    x   = 0 ;
+
+#ifdef __SSE2__
+    {
+      const __m128i sign = _mm_set1_epi8 ((char)0x80) ;
+      const __m128i t    = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)bayer [r]), sign) ;
+      const __m128i b    = _mm_set1_epi8 ((char)bit) ;
+      __m128i g, a ;
+
+      for ( ; x + 16 <= w ; x += 16)
+      {
+        g = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)(src + x)), sign) ;
+        a = _mm_loadu_si128 ((const __m128i *)(acc + x)) ;
+        a = _mm_or_si128 (a, _mm_and_si128 (_mm_cmpgt_epi8 (g, t), b)) ;
+        _mm_storeu_si128 ((__m128i *)(acc + x), a) ;
+      }
+    }
+#endif
+
+    for ( ; x < w ; ++x)
+      if (src [x] > bayer [r][x & 15])
+        acc [x] |= bit ;
+  }
+}
+
+
+/*
+ * diffuseStrip:
+ *	Floyd-Steinberg or Atkinson error diffusion over the rows of a
+ *	strip. err [0..2] are the error lines for this row and the next
+ *	two, offset by 2 so x - 2 .. x + 2 need no bounds checks; they
+ *	carry over from strip to strip.
+ *********************************************************************************
+ */
+static void diffuseStrip (uint8 *acc, const uint8 *gray, int32 w, int32 rows, int32 stride,
+                          int32 algo, short *err [3])
+{
+  const uint8 *src ;
+  short *e0, *e1, *e2, *t ;
+  int32 r, x, v, e ;
+  uint8 bit ;
+
+  for (r = 0 ; r < rows ; ++r)
+  {
+    src = gray + r * stride ;
+    bit = (uint8)(1 << r) ;
+    e0  = err [0] + 2 ;
+    e1  = err [1] + 2 ;
+    e2  = err [2] + 2 ;
+
+    for (x = 0 ; x < w ; ++x)
+    {
+      v = src [x] + e0 [x] ;
+      if (v >= 128)
+      {
+        acc [x] |= bit ;
+        e = v - 255 ;
+      }
+      else
+        e = v ;
+
+      if (algo == LCD_DITHER_FLOYD)
+      {
+        e0 [x + 1] += (short)((e * 7) >> 4) ;
+        e1 [x - 1] += (short)((e * 3) >> 4) ;
+        e1 [x    ] += (short)((e * 5) >> 4) ;
+        e1 [x + 1] += (short)( e      >> 4) ;
+      }
+      else
+      {
+        e >>= 3 ;
+        e0 [x + 1] += (short)e ;
+        e0 [x + 2] += (short)e ;
+        e1 [x - 1] += (short)e ;
+        e1 [x    ] += (short)e ;
+        e1 [x + 1] += (short)e ;
+        e2 [x    ] += (short)e ;
+      }
+    }
+
+    // Rotate the error lines; the oldest becomes the new line two down
+
+    t       = err [0] ;
+    err [0] = err [1] ;
+    err [1] = err [2] ;
+    err [2] = t ;
+    memset (t, 0, (w + 4) * sizeof (short)) ;
+  }
+}
+
+
+/*
+ * lcd128x64dither:
+ *	Dither a w x h grayscale image (stride bytes per row, 255 lit)
+ *	into page-major bytes: page p of column x is stored at
+ *	out [x * colStride + p * pageStride]. Bits below the image in the
+ *	last page are cleared. Returns -1 for a bad algorithm or an image
+ *	wider than 256.
+ *********************************************************************************
+ */
+int32 lcd128x64dither (const uint8 *gray, int32 w, int32 h, int32 stride, int32 algo,
+                       uint8 *out, int32 colStride, int32 pageStride)
+{
+  uint8 acc [DITHER_MAX_WIDTH] ;
+  short lines [3][DITHER_MAX_WIDTH + 4] ;
+  short *err [3] = { lines [0], lines [1], lines [2] } ;
+  int32 y, x, rows ;
+
+  if ((gray == NULL) || (out == NULL) || (w <= 0) || (h <= 0) || (w > DITHER_MAX_WIDTH) ||
+      (algo < LCD_DITHER_BAYER) || (algo > LCD_DITHER_ATKINSON))
+    return -1 ;
+
+  memset (lines, 0, sizeof (lines)) ;
+
+  for (y = 0 ; y < h ; y += 8)
+  {
+    rows = (h - y < 8) ? (h - y) : 8 ;
+    memset (acc, 0, w) ;
+
+    if (algo == LCD_DITHER_BAYER)
+      bayerStrip (acc, gray + y * stride, w, rows, stride) ;
+    else
+      diffuseStrip (acc, gray + y * stride, w, rows, stride, algo, err) ;
+
+    for (x = 0 ; x < w ; ++x)
+      out [x * colStride] = acc [x] ;
+    out += pageStride ;
+  }
+
+  return 0 ;
+}
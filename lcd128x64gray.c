@@ -0,0 +1,295 @@
+/*
+ * lcd128x64gray.c:
+ *	Four grey levels on a one-bit panel. The surface holds two bits a
+ *	pixel, kept as a high and a low bit-plane, and a thread shows it as
+ *	a cycle of three planes at a fixed rate:
+ *	  high | low, high, high & low
+ *	so level 3 is lit for the whole cycle, level 2 for two thirds and
+ *	level 1 for one third. Each plane goes through the framebuffer and
+ *	lcd128x64flush, so only the bytes that differ from the plane before
+ *	are sent, and it runs on whatever transport is in use; the hardware
+ *	SPI one is the only one fast enough for a steady picture.
+ *
+ *	While the thread runs it owns the driver: draw with the functions
+ *	here, which write to a back buffer, and lcd128x64grayCommit to show
+ *	it. The thread picks up a commit at the start of its next cycle.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "lcd128x64gray.h"
+
+#define GRAY_BYTES  (LCD_WIDTH * LCD_HEIGHT)
+#define GRAY_PLANES 3
+
+// The back planes are the caller's, the front ones are shared with
+// the thread under grayLock
+
+static uint8 backHi  [GRAY_BYTES], backLo  [GRAY_BYTES] ;
+static uint8 frontHi [GRAY_BYTES], frontLo [GRAY_BYTES] ;
+static pthread_mutex_t grayLock = PTHREAD_MUTEX_INITIALIZER ;
+
+static int32  width, height ;
+static int32  running = 0 ;
+static int32  stopping ;
+static int32  period ;		// ns a plane
+static pthread_t thread ;
+
+// Written by the thread under grayLock
+
+static uint32 planes, late, bytes ;
+static uint64 jitterSum, jitterMax ;
+static struct timespec start, last ;
+
+
+/*
+ * nsSince:
+ *	Nanoseconds from a to b.
+ *********************************************************************************
+ */
+static long long nsSince (const struct timespec *a, const struct timespec *b)
+{
+  return (long long)(b->tv_sec - a->tv_sec) * 1000000000 + (b->tv_nsec - a->tv_nsec) ;
+}
+
+static void addNs (struct timespec *t, int32 ns)
+{
+  t->tv_nsec += ns ;
+  while (t->tv_nsec >= 1000000000)
+  {
+    t->tv_nsec -= 1000000000 ;
+    ++t->tv_sec ;
+  }
+}
+
+
+/*
+ * grayLoop:
+ *	The plane thread. Planes start on a fixed grid of period ns; one
+ *	that starts after its slot has ended is late, and the grid moves
+ *	on from there rather than sending a burst to catch up.
+ *********************************************************************************
+ */
+static void *grayLoop (void *arg)
+{
+  static uint8 hi [GRAY_BYTES], lo [GRAY_BYTES], plane [GRAY_BYTES] ;
+  struct timespec next, now ;
+  int32 n = 0, i, wasLate ;
+  uint32 sent ;
+  long long ns ;
+
+  (void)arg ;
+
+  clock_gettime (CLOCK_MONOTONIC, &next) ;
+
+  while (!__atomic_load_n (&stopping, __ATOMIC_ACQUIRE))
+  {
+    if (n == 0)
+    {
+      pthread_mutex_lock (&grayLock) ;
+      memcpy (hi, frontHi, GRAY_BYTES) ;
+      memcpy (lo, frontLo, GRAY_BYTES) ;
+      pthread_mutex_unlock (&grayLock) ;
+    }
+
+    switch (n)
+    {
+      case 0:  for (i = 0 ; i < GRAY_BYTES ; ++i) plane [i] = hi [i] | lo [i] ; break ;
+      case 1:  memcpy (plane, hi, GRAY_BYTES) ;                                break ;
+      default: for (i = 0 ; i < GRAY_BYTES ; ++i) plane [i] = hi [i] & lo [i] ; break ;
+    }
+
+    sent = lcd128x64bytesSent () ;
+    lcd128x64restore (0, 0, width, height, plane) ;
+    lcd128x64flush () ;
+    sent = lcd128x64bytesSent () - sent ;
+
+    n = (n + 1) % GRAY_PLANES ;
+
+// Wait for the start of the next slot
+
+    addNs (&next, period) ;
+    clock_gettime (CLOCK_MONOTONIC, &now) ;
+    wasLate = nsSince (&next, &now) > 0 ;
+    if (wasLate)
+      next = now ;
+    else
+    {
+      while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR)
+        ;
+      clock_gettime (CLOCK_MONOTONIC, &now) ;
+    }
+    ns = nsSince (&next, &now) ;
+
+    pthread_mutex_lock (&grayLock) ;
+    ++planes ;
+    late  += wasLate ;
+    bytes += sent ;
+    if (!wasLate)
+    {
+      jitterSum += (uint64)ns ;
+      if ((uint64)ns > jitterMax)
+        jitterMax = (uint64)ns ;
+    }
+    last = now ;
+    pthread_mutex_unlock (&grayLock) ;
+  }
+
+  return NULL ;
+}
+
+
+/*
+ * lcd128x64grayStart: lcd128x64grayStop:
+ *	Start showing the grey surface at planeRate planes a second, a
+ *	third of that being the flicker rate, and stop again. The surface
+ *	keeps the size and orientation of the screen when started.
+ *	Stopping leaves the last plane in the framebuffer.
+ *********************************************************************************
+ */
+int32 lcd128x64grayStart (int32 planeRate)
+{
+  if (running || (planeRate <= 0))
+    return -1 ;
+
+  lcd128x64getScreenSize (&width, &height) ;
+  period   = 1000000000 / planeRate ;
+  stopping = 0 ;
+  planes   = late = bytes = 0 ;
+  jitterSum = jitterMax = 0 ;
+  clock_gettime (CLOCK_MONOTONIC, &start) ;
+  last = start ;
+
+  if (pthread_create (&thread, NULL, grayLoop, NULL) != 0)
+    return -1 ;
+
+  running = 1 ;
+  return 0 ;
+}
+
+void lcd128x64grayStop (lcd128x64grayStats *stats)
+{
+  if (!running)
+    return ;
+
+  __atomic_store_n (&stopping, 1, __ATOMIC_RELEASE) ;
+  pthread_join (thread, NULL) ;
+  running = 0 ;
+
+  lcd128x64grayGetStats (stats) ;
+}
+
+
+/*
+ * lcd128x64grayGetStats:
+ *	How the plane thread is keeping up, from its start until now.
+ *********************************************************************************
+ */
+void lcd128x64grayGetStats (lcd128x64grayStats *stats)
+{
+  uint32 onTime ;
+
+  if (stats == NULL)
+    return ;
+
+  pthread_mutex_lock (&grayLock) ;
+
+  stats->planes  = planes ;
+  stats->late    = late ;
+  stats->bytes   = bytes ;
+  stats->seconds = nsSince (&start, &last) / 1e9 ;
+  stats->planeRate = stats->seconds > 0 ? planes / stats->seconds : 0 ;
+  stats->cycleRate = stats->planeRate / GRAY_PLANES ;
+  onTime = planes - late ;
+  stats->jitterMean = onTime ? jitterSum / 1e3 / onTime : 0 ;
+  stats->jitterMax  = jitterMax / 1e3 ;
+  stats->bytesPerPlane = planes ? (double)bytes / planes : 0 ;
+
+  pthread_mutex_unlock (&grayLock) ;
+}
+
+
+/*
+ * lcd128x64grayClear: lcd128x64grayPoint:
+ *	Fill the surface, or set one pixel, to a level from 0 to 3.
+ *********************************************************************************
+ */
+void lcd128x64grayClear (int32 level)
+{
+  memset (backHi, (level & 2) ? 0xFF : 0x00, GRAY_BYTES) ;
+  memset (backLo, (level & 1) ? 0xFF : 0x00, GRAY_BYTES) ;
+}
+
+void lcd128x64grayPoint (int32 x, int32 y, int32 level)
+{
+  int32 i ;
+  uint8 bit ;
+
+  if (width == 0)
+    lcd128x64getScreenSize (&width, &height) ;
+
+  if ((x < 0) || (x >= width) || (y < 0) || (y >= height))
+    return ;
+
+  i   = (y / 8) * width + x ;
+  bit = 1 << (y & 7) ;
+
+  if (level & 2) backHi [i] |= bit ; else backHi [i] &= ~bit ;
+  if (level & 1) backLo [i] |= bit ; else backLo [i] &= ~bit ;
+}
+
+
+/*
+ * lcd128x64grayPut:
+ *	Put a w x h 8-bit grey image, the top two bits of each pixel
+ *	giving its level. Rows are stride bytes apart. Clipped.
+ *********************************************************************************
+ */
+void lcd128x64grayPut (int32 x, int32 y, int32 w, int32 h, const uint8 *gray, int32 stride)
+{
+  int32 r, c ;
+
+  if (gray == NULL)
+    return ;
+
+  for (r = 0 ; r < h ; ++r)
+    for (c = 0 ; c < w ; ++c)
+      lcd128x64grayPoint (x + c, y + r, gray [r * stride + c] >> 6) ;
+}
+
+
+/*
+ * lcd128x64grayCommit:
+ *	Show what has been drawn, from the next grey cycle on.
+ *********************************************************************************
+ */
+void lcd128x64grayCommit (void)
+{
+  pthread_mutex_lock (&grayLock) ;
+  memcpy (frontHi, backHi, GRAY_BYTES) ;
+  memcpy (frontLo, backLo, GRAY_BYTES) ;
+  pthread_mutex_unlock (&grayLock) ;
+}
@@ -0,0 +1,55 @@
+/*
+ * lcd128x64gray.h:
+ *	Four grey levels by cycling bit-planes on a dedicated thread.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+#ifndef __LCD128X64GRAY_H_
+#define __LCD128X64GRAY_H_
+
+#include "lcd128x64.h"
+
+// Grey levels, 0 off to 3 fully on
+#define	LCD_GRAY_LEVELS   4
+
+typedef struct lcd128x64grayStats
+{
+  uint32 planes ;		// planes sent
+  uint32 late ;			// planes that overran their slot
+  uint32 bytes ;		// bytes sent to the panel
+  double seconds ;
+  double planeRate ;		// planes per second
+  double cycleRate ;		// grey cycles per second, the flicker rate
+  double jitterMean ;		// how late a plane started, in microseconds
+  double jitterMax ;
+  double bytesPerPlane ;
+} lcd128x64grayStats ;
+
+extern int32  lcd128x64grayStart         (int32 planeRate) ;
+extern void   lcd128x64grayStop          (lcd128x64grayStats *stats) ;
+extern void   lcd128x64grayGetStats      (lcd128x64grayStats *stats) ;
+extern void   lcd128x64grayClear         (int32 level) ;
+extern void   lcd128x64grayPoint         (int32  x, int32  y, int32 level) ;
+extern void   lcd128x64grayPut           (int32  x, int32  y, int32 w, \
+                                            int32  h, const uint8 *gray, \
+                                            int32 stride) ;
+extern void   lcd128x64grayCommit        (void) ;
+
+#endif
@@ -0,0 +1,264 @@
+/*
+ * lcd128x64rec.c:
+ *	Record what the panel shows to a video file (see lcd128x64video.h)
+ *	in the background. A frame hook copies every frame into a small
+ *	single-producer, single-consumer ring of slots and returns; a
+ *	writer thread encodes the deltas and does the file I/O. When the
+ *	ring is full the frame is dropped rather than waiting, so the
+ *	render thread never blocks on the recorder. Dropped frames only
+ *	lose their timing: the next delta is taken against the last frame
+ *	recorded, so the picture stays right.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include "lcd128x64video.h"
+
+#define REC_SLOTS   8
+#define REC_FRAME   (LCD_WIDTH * LCD_HEIGHT)
+
+struct recSlot
+{
+  uint32 time ;
+  uint8  frame [REC_FRAME] ;
+} ;
+
+// head is only written by the hook, tail only by the writer thread
+
+static struct recSlot slots [REC_SLOTS] ;
+static uint32 head = 0, tail = 0 ;
+static sem_t  ready ;
+
+static pthread_t thread ;
+static FILE  *out = NULL ;
+static int32  recKeyInterval ;
+static int32  stopping ;
+static struct timespec start ;
+
+// Producer and consumer side counters, each written by one side only
+
+static uint32 queued, dropped ;
+static uint64 hookNs ;
+static uint32 written, keyframes, bytes ;
+
+
+/*
+ * put16: put32:
+ *	Write little-endian numbers.
+ *********************************************************************************
+ */
+static void put16 (uint32 v)
+{
+  fputc (v & 0xFF, out) ;
+  fputc ((v >> 8) & 0xFF, out) ;
+}
+
+static void put32 (uint32 v)
+{
+  put16 (v & 0xFFFF) ;
+  put16 (v >> 16) ;
+}
+
+
+/*
+ * nsSince:
+ *	Nanoseconds from t0 to t1.
+ *********************************************************************************
+ */
+static uint64 nsSince (const struct timespec *t0, const struct timespec *t1)
+{
+  return (uint64)((t1->tv_sec - t0->tv_sec) * 1000000000LL + (t1->tv_nsec - t0->tv_nsec)) ;
+}
+
+
+/*
+ * recHook:
+ *	Frame hook: copy the frame into the next free slot, or drop it.
+ *********************************************************************************
+ */
+static void recHook (const lcd128x64frame *frame, void *arg)
+{
+  struct timespec t0, t1 ;
+  struct recSlot *slot ;
+  uint32 h = head ;
+
+  (void)arg ;
+  clock_gettime (CLOCK_MONOTONIC, &t0) ;
+
+  if (h - __atomic_load_n (&tail, __ATOMIC_ACQUIRE) == REC_SLOTS)
+    ++dropped ;
+  else
+  {
+    slot       = &slots [h % REC_SLOTS] ;
+    slot->time = (uint32)(nsSince (&start, &t0) / 1000000) ;
+    memcpy (slot->frame, frame->panel, REC_FRAME) ;
+    __atomic_store_n (&head, h + 1, __ATOMIC_RELEASE) ;
+    sem_post (&ready) ;
+    ++queued ;
+  }
+
+  clock_gettime (CLOCK_MONOTONIC, &t1) ;
+  hookNs += nsSince (&t0, &t1) ;
+}
+
+
+/*
+ * recThread:
+ *	Encode and write queued frames until told to stop and the ring
+ *	is empty.
+ *********************************************************************************
+ */
+static void *recThread (void *arg)
+{
+  static uint8 prev [REC_FRAME], delta [LVID_MAX_DELTA (REC_FRAME)] ;
+  struct recSlot *slot ;
+  uint32 t, time ;
+  int32 key, size ;
+
+  (void)arg ;
+
+  for (;;)
+  {
+    while ((sem_wait (&ready) < 0) && (errno == EINTR))
+      ;
+
+    t = tail ;
+    if (t == __atomic_load_n (&head, __ATOMIC_ACQUIRE))
+    {
+      if (__atomic_load_n (&stopping, __ATOMIC_ACQUIRE))
+        break ;
+      continue ;
+    }
+
+    slot = &slots [t % REC_SLOTS] ;
+    key  = (written == 0) || ((recKeyInterval > 0) && (written % recKeyInterval == 0)) ;
+    size = lcd128x64deltaEncode (key ? NULL : prev, slot->frame, REC_FRAME, delta) ;
+    time = slot->time ;
+    memcpy (prev, slot->frame, REC_FRAME) ;
+    __atomic_store_n (&tail, t + 1, __ATOMIC_RELEASE) ;
+
+    fputc (key ? LVID_KEY : LVID_DELTA, out) ;
+    fputc (0, out) ; fputc (0, out) ; fputc (0, out) ;
+    put32 (time) ;
+    put32 ((uint32)size) ;
+    fwrite (delta, 1, (size_t)size, out) ;
+
+    ++written ;
+    keyframes += key ;
+    bytes     += LVID_RECORD + size ;
+  }
+
+  return NULL ;
+}
+
+
+/*
+ * lcd128x64recordStart:
+ *	Start recording every frame sent to the panel into fileName, with
+ *	a keyframe every keyInterval frames (0 for only the first). The
+ *	first frame recorded is the whole screen. Returns -1 if already
+ *	recording or the file or thread can't be created.
+ *********************************************************************************
+ */
+int32 lcd128x64recordStart (const char *fileName, int32 keyInterval)
+{
+  if (out != NULL)
+    return -1 ;
+
+  if ((out = fopen (fileName, "wb")) == NULL)
+    return -1 ;
+
+  fwrite ("LVID", 1, 4, out) ;
+  put16 (LCD_WIDTH) ;
+  put16 (LCD_HEIGHT * 8) ;
+  put32 (0) ;
+  put32 (0) ;
+
+  head = tail = 0 ;
+  queued = dropped = written = keyframes = 0 ;
+  bytes  = LVID_HEADER ;
+  hookNs = 0 ;
+  stopping = 0 ;
+  recKeyInterval = keyInterval ;
+  clock_gettime (CLOCK_MONOTONIC, &start) ;
+  sem_init (&ready, 0, 0) ;
+
+  if (pthread_create (&thread, NULL, recThread, NULL) != 0)
+  {
+    sem_destroy (&ready) ;
+    fclose (out) ;
+    out = NULL ;
+    return -1 ;
+  }
+
+  if (lcd128x64addFrameHook (recHook, NULL) < 0)
+  {
+    __atomic_store_n (&stopping, 1, __ATOMIC_RELEASE) ;
+    sem_post (&ready) ;
+    pthread_join (thread, NULL) ;
+    sem_destroy (&ready) ;
+    fclose (out) ;
+    out = NULL ;
+    return -1 ;
+  }
+
+  return 0 ;
+}
+
+
+/*
+ * lcd128x64recordStop:
+ *	Stop recording, write out what is still queued and close the
+ *	file. Must be called from the thread that sends frames. stats
+ *	may be NULL.
+ *********************************************************************************
+ */
+void lcd128x64recordStop (lcd128x64recordStats *stats)
+{
+  if (out == NULL)
+    return ;
+
+  lcd128x64removeFrameHook (recHook, NULL) ;
+  __atomic_store_n (&stopping, 1, __ATOMIC_RELEASE) ;
+  sem_post (&ready) ;
+  pthread_join (thread, NULL) ;
+  sem_destroy (&ready) ;
+
+  fseek (out, 8, SEEK_SET) ;
+  put32 (written) ;
+  fclose (out) ;
+  out = NULL ;
+
+  if (stats != NULL)
+  {
+    stats->frames     = written ;
+    stats->dropped    = dropped ;
+    stats->keyframes  = keyframes ;
+    stats->bytes      = bytes ;
+    stats->nsPerFrame = (queued + dropped) ? (double)hookNs / (queued + dropped) : 0 ;
+  }
+}
@@ -0,0 +1,188 @@
+/*
+ * lcd128x64shm.c:
+ *	Publish what the panel shows in a POSIX shared memory segment
+ *	(see lcd128x64shm.h). A frame hook appends the columns sent in
+ *	each frame to the span ring and patches them into the latest
+ *	frame under a sequence lock, so publishing costs no system calls,
+ *	is proportional to what changed and never waits for readers.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "lcd128x64shm.h"
+
+static lcd128x64shm *shm = NULL ;
+static char shmName [64] ;
+static uint32 ringPos ;
+
+
+/*
+ * ringPut:
+ *	Append one record to the ring, padding to the start first if it
+ *	doesn't fit before the end.
+ *********************************************************************************
+ */
+static void ringPut (uint32 page, uint32 lo, const void *bytes, uint32 len)
+{
+  lcd128x64span span ;
+  uint32 off  = ringPos & (LCD_SHM_RING - 1) ;
+  uint32 size = LCD_SHM_REC_SIZE (len) ;
+
+  memset (&span, 0, sizeof (span)) ;
+  if (off + size > LCD_SHM_RING)
+  {
+    span.page = LCD_SPAN_PAD ;
+    memcpy (shm->ring + off, &span, sizeof (span)) ;
+    ringPos += LCD_SHM_RING - off ;
+    off      = 0 ;
+  }
+
+  span.page = (unsigned short)page ;
+  span.lo   = (unsigned short)lo ;
+  span.len  = (unsigned short)len ;
+  memcpy (shm->ring + off, &span, sizeof (span)) ;
+  memcpy (shm->ring + off + sizeof (span), bytes, len) ;
+  ringPos += size ;
+}
+
+
+/*
+ * shareHook:
+ *	Frame hook: copy the changed spans into the segment.
+ *********************************************************************************
+ */
+static void shareHook (const lcd128x64frame *frame, void *arg)
+{
+  uint32 seq = shm->seq ;
+  uint32 total = LCD_SHM_REC_SIZE (sizeof (uint32)) ;
+  int32 p ;
+
+  (void)arg ;
+
+  // The ring first: claim the space (allowing for one pad), fill it,
+  //	then publish the frame
+
+  for (p = 0 ; p < LCD_HEIGHT ; ++p)
+    if (frame->lo [p] <= frame->hi [p])
+      total += LCD_SHM_REC_SIZE (frame->hi [p] - frame->lo [p] + 1) ;
+
+  __atomic_store_n (&shm->ringWriteEnd, ringPos + total + LCD_SHM_REC_SIZE (LCD_WIDTH), __ATOMIC_RELAXED) ;
+  __atomic_thread_fence (__ATOMIC_RELEASE) ;
+
+  for (p = 0 ; p < LCD_HEIGHT ; ++p)
+    if (frame->lo [p] <= frame->hi [p])
+      ringPut (p, frame->lo [p], frame->panel + p * LCD_WIDTH + frame->lo [p],
+               frame->hi [p] - frame->lo [p] + 1) ;
+  ringPut (LCD_SPAN_END, 0, &frame->number, sizeof (uint32)) ;
+
+  __atomic_store_n (&shm->ringHead, ringPos, __ATOMIC_RELEASE) ;
+  __atomic_store_n (&shm->ringWriteEnd, ringPos, __ATOMIC_RELAXED) ;
+
+  // Then the latest frame
+
+  __atomic_store_n (&shm->seq, seq + 1, __ATOMIC_RELAXED) ;
+  __atomic_thread_fence (__ATOMIC_RELEASE) ;
+
+  for (p = 0 ; p < LCD_HEIGHT ; ++p)
+    if (frame->lo [p] <= frame->hi [p])
+      memcpy (shm->panel + p * LCD_WIDTH + frame->lo [p],
+              frame->panel + p * LCD_WIDTH + frame->lo [p],
+              frame->hi [p] - frame->lo [p] + 1) ;
+  shm->frame      = frame->number ;
+  shm->ringCursor = ringPos ;
+
+  __atomic_store_n (&shm->seq, seq + 2, __ATOMIC_RELEASE) ;
+}
+
+
+/*
+ * lcd128x64shareStart:
+ *	Create the segment (LCD_SHM_NAME if name is NULL) and publish every
+ *	frame from now on. Returns -1 if already sharing or the segment
+ *	can't be created.
+ *********************************************************************************
+ */
+int32 lcd128x64shareStart (const char *name)
+{
+  int32 fd ;
+  void *p ;
+
+  if (shm != NULL)
+    return -1 ;
+
+  snprintf (shmName, sizeof (shmName), "%s", (name != NULL) ? name : LCD_SHM_NAME) ;
+
+  if ((fd = shm_open (shmName, O_RDWR | O_CREAT, 0644)) < 0)
+    return -1 ;
+
+  if (ftruncate (fd, sizeof (lcd128x64shm)) < 0)
+  {
+    close (fd) ;
+    shm_unlink (shmName) ;
+    return -1 ;
+  }
+
+  p = mmap (NULL, sizeof (lcd128x64shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) ;
+  close (fd) ;
+  if (p == MAP_FAILED)
+  {
+    shm_unlink (shmName) ;
+    return -1 ;
+  }
+
+  shm     = p ;
+  ringPos = 0 ;
+  memset (shm, 0, sizeof (lcd128x64shm)) ;
+  shm->width  = LCD_WIDTH ;
+  shm->height = LCD_HEIGHT * 8 ;
+  __atomic_store_n (&shm->magic, LCD_SHM_MAGIC, __ATOMIC_RELEASE) ;
+
+  if (lcd128x64addFrameHook (shareHook, NULL) < 0)
+  {
+    lcd128x64shareStop () ;
+    return -1 ;
+  }
+
+  return 0 ;
+}
+
+
+/*
+ * lcd128x64shareStop:
+ *	Stop publishing and remove the segment. Readers that still have it
+ *	mapped keep the last frame.
+ *********************************************************************************
+ */
+void lcd128x64shareStop (void)
+{
+  if (shm == NULL)
+    return ;
+
+  lcd128x64removeFrameHook (shareHook, NULL) ;
+  munmap (shm, sizeof (lcd128x64shm)) ;
+  shm_unlink (shmName) ;
+  shm = NULL ;
+}
@@ -0,0 +1,105 @@
+/*
+ * lcd128x64shm.h:
+ *	The panel published in POSIX shared memory, for viewers in other
+ *	processes.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+#ifndef __LCD128X64SHM_H_
+#define __LCD128X64SHM_H_
+
+#include "lcd128x64.h"
+
+#define	LCD_SHM_NAME    "/lcd128x64"
+#define	LCD_SHM_MAGIC   0x5344434C	// "LCDS"
+
+// Size of the span ring, a power of 2
+#define	LCD_SHM_RING    65536
+
+// The segment holds two views of the panel.
+//
+//	panel is the latest frame, laid out as in lcd128x64frame. seq is
+//	odd while the publisher is writing it; a reader copies between two
+//	reads of an even, unchanged seq. ringCursor is where the ring
+//	carries on from this frame.
+//
+//	ring is a byte ring of every span sent, for consumers that follow
+//	frame by frame. Positions count bytes ever written, so position p
+//	is at ring [p % LCD_SHM_RING]. A record is a lcd128x64span header
+//	and len bytes, padded to 8 (LCD_SHM_REC_SIZE); page LCD_SPAN_END
+//	closes a frame and is followed by its uint32 number, page
+//	LCD_SPAN_PAD means carry on from the start of the ring. ringHead
+//	moves once a whole frame is written. ringWriteEnd moves first, to
+//	the end of what is about to be written: a reader whose records lie
+//	more than LCD_SHM_RING behind it has been overrun and must resync
+//	from panel.
+typedef struct lcd128x64shm
+{
+  uint32 magic ;
+  uint32 width, height ;
+  uint32 seq ;
+  uint32 frame ;
+  uint32 ringCursor ;
+  uint32 ringHead ;
+  uint32 ringWriteEnd ;
+  uint8  panel [LCD_WIDTH * LCD_HEIGHT] ;
+  uint8  ring [LCD_SHM_RING] ;
+} lcd128x64shm ;
+
+#define	LCD_SPAN_END    0xFFFE
+#define	LCD_SPAN_PAD    0xFFFF
+
+typedef struct lcd128x64span
+{
+  unsigned short page ;
+  unsigned short lo ;		// first column
+  unsigned short len ;		// bytes that follow
+  unsigned short reserved ;
+} lcd128x64span ;
+
+// Ring bytes a record of len bytes takes. Padding to 8 keeps every
+//	header whole before the end of the ring.
+#define	LCD_SHM_REC_SIZE(len)   ((sizeof (lcd128x64span) + (len) + 7) & ~7u)
+
+// A consumer: its own cursor into the ring and copy of the panel
+typedef struct lcd128x64sub
+{
+  const lcd128x64shm *shm ;
+  uint32 cursor ;
+  uint32 frame ;
+  uint32 resyncs ;
+  uint8  panel [LCD_WIDTH * LCD_HEIGHT] ;
+} lcd128x64sub ;
+
+typedef void (*lcd128x64spanFn) (const lcd128x64span *span, const uint8 *bytes, void *arg) ;
+
+extern int32  lcd128x64shareStart        (const char *name) ;
+extern void   lcd128x64shareStop         (void) ;
+
+extern const lcd128x64shm *lcd128x64shareOpen (const char *name) ;
+extern void   lcd128x64shareClose        (const lcd128x64shm *shm) ;
+extern uint32 lcd128x64shareRead         (const lcd128x64shm *shm, uint8 *panel, \
+                                            uint32 *cursor) ;
+extern void   lcd128x64subInit           (lcd128x64sub *sub, const lcd128x64shm *shm) ;
+extern int32  lcd128x64subNext           (lcd128x64sub *sub, lcd128x64spanFn fn, \
+                                            void *arg) ;
+
+
+#endif
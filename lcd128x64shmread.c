@@ -0,0 +1,200 @@
+/*
+ * lcd128x64shmread.c:
+ *	The reading side of the shared memory segment (see lcd128x64shm.h),
+ *	for viewers and other consumers in other processes. Nothing here
+ *	touches the display, so tools can link it on their own.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "lcd128x64shm.h"
+
+// Most a frame can take in the ring: a span per page and the end
+#define FRAME_MAX       (LCD_HEIGHT * LCD_SHM_REC_SIZE (LCD_WIDTH) + LCD_SHM_REC_SIZE (sizeof (uint32)))
+
+
+/*
+ * lcd128x64shareOpen: lcd128x64shareClose:
+ *	Map a published segment read-only (LCD_SHM_NAME if name is NULL).
+ *	Returns NULL if there is none.
+ *********************************************************************************
+ */
+const lcd128x64shm *lcd128x64shareOpen (const char *name)
+{
+  const lcd128x64shm *shm ;
+  int32 fd ;
+
+  if ((fd = shm_open ((name != NULL) ? name : LCD_SHM_NAME, O_RDONLY, 0)) < 0)
+    return NULL ;
+
+  shm = mmap (NULL, sizeof (lcd128x64shm), PROT_READ, MAP_SHARED, fd, 0) ;
+  close (fd) ;
+  if (shm == MAP_FAILED)
+    return NULL ;
+
+  if (__atomic_load_n (&shm->magic, __ATOMIC_ACQUIRE) != LCD_SHM_MAGIC)
+  {
+    munmap ((void *)shm, sizeof (lcd128x64shm)) ;
+    return NULL ;
+  }
+
+  return shm ;
+}
+
+void lcd128x64shareClose (const lcd128x64shm *shm)
+{
+  if (shm != NULL)
+    munmap ((void *)shm, sizeof (lcd128x64shm)) ;
+}
+
+
+/*
+ * lcd128x64shareRead:
+ *	Copy a consistent frame out of the segment into panel, which holds
+ *	LCD_WIDTH * LCD_HEIGHT bytes, and if cursor isn't NULL the ring
+ *	position that follows it. Returns the frame number. Spins while
+ *	the publisher is mid-frame; it never takes long.
+ *********************************************************************************
+ */
+uint32 lcd128x64shareRead (const lcd128x64shm *shm, uint8 *panel, uint32 *cursor)
+{
+  uint32 seq, frame, pos ;
+
+  for (;;)
+  {
+    seq = __atomic_load_n (&shm->seq, __ATOMIC_ACQUIRE) ;
+    if (seq & 1)
+      continue ;
+
+    memcpy (panel, shm->panel, sizeof (shm->panel)) ;
+    frame = shm->frame ;
+    pos   = shm->ringCursor ;
+
+    __atomic_thread_fence (__ATOMIC_ACQUIRE) ;
+    if (__atomic_load_n (&shm->seq, __ATOMIC_RELAXED) == seq)
+      break ;
+  }
+
+  if (cursor != NULL)
+    *cursor = pos ;
+  return frame ;
+}
+
+
+/*
+ * lcd128x64subInit:
+ *	Start following the segment from its latest frame.
+ *********************************************************************************
+ */
+void lcd128x64subInit (lcd128x64sub *sub, const lcd128x64shm *shm)
+{
+  sub->shm     = shm ;
+  sub->resyncs = 0 ;
+  sub->frame   = lcd128x64shareRead (shm, sub->panel, &sub->cursor) ;
+}
+
+
+/*
+ * lcd128x64subNext:
+ *	Apply every frame published since the last call to sub->panel,
+ *	calling fn (if not NULL) for each span. Each frame is copied out
+ *	of the ring and checked against ringWriteEnd before it is used.
+ *	Returns the number of frames applied, or -1 if the publisher got
+ *	more than a ring ahead: then sub->panel has been reloaded from the
+ *	latest frame, without calling fn.
+ *********************************************************************************
+ */
+int32 lcd128x64subNext (lcd128x64sub *sub, lcd128x64spanFn fn, void *arg)
+{
+  const lcd128x64shm *shm = sub->shm ;
+  uint8 stage [FRAME_MAX] ;
+  lcd128x64span span ;
+  uint32 head, pos, off, size, n, k, number ;
+  int32 frames = 0 ;
+
+  for (;;)
+  {
+    head = __atomic_load_n (&shm->ringHead, __ATOMIC_ACQUIRE) ;
+    if (head == sub->cursor)
+      return frames ;
+    if (head - sub->cursor > LCD_SHM_RING)
+      break ;
+
+    // Copy the next frame out
+
+    for (pos = sub->cursor, n = 0 ; ; )
+    {
+      off = pos & (LCD_SHM_RING - 1) ;
+      memcpy (&span, shm->ring + off, sizeof (span)) ;
+      if (span.page == LCD_SPAN_PAD)
+      {
+        pos += LCD_SHM_RING - off ;
+        continue ;
+      }
+
+      size = LCD_SHM_REC_SIZE (span.len) ;
+      if ((span.len > LCD_WIDTH) || (off + size > LCD_SHM_RING) ||
+          (n + size > FRAME_MAX) || (pos + size - sub->cursor > head - sub->cursor))
+        break ;
+
+      memcpy (stage + n, shm->ring + off, size) ;
+      n   += size ;
+      pos += size ;
+      if (span.page == LCD_SPAN_END)
+        break ;
+    }
+
+    __atomic_thread_fence (__ATOMIC_ACQUIRE) ;
+    if ((__atomic_load_n (&shm->ringWriteEnd, __ATOMIC_RELAXED) - sub->cursor > LCD_SHM_RING) ||
+        (span.page != LCD_SPAN_END))
+      break ;
+
+    // It wasn't overwritten while we copied it: apply it
+
+    for (k = 0 ; k < n ; k += LCD_SHM_REC_SIZE (span.len))
+    {
+      memcpy (&span, stage + k, sizeof (span)) ;
+      if (span.page == LCD_SPAN_END)
+      {
+        memcpy (&number, stage + k + sizeof (span), sizeof (number)) ;
+        sub->frame = number ;
+      }
+      else if ((span.page < LCD_HEIGHT) && (span.lo + span.len <= LCD_WIDTH))
+      {
+        memcpy (sub->panel + span.page * LCD_WIDTH + span.lo, stage + k + sizeof (span), span.len) ;
+        if (fn != NULL)
+          fn (&span, stage + k + sizeof (span), arg) ;
+      }
+    }
+
+    sub->cursor = pos ;
+    ++frames ;
+  }
+
+  ++sub->resyncs ;
+  sub->frame = lcd128x64shareRead (shm, sub->panel, &sub->cursor) ;
+  return -1 ;
+}
@@ -0,0 +1,209 @@
+/*
+ * lcd128x64spi.c:
+ *	The wiringPi transports for lcd128x64: the SH1106 on bit-banged
+ *	SPI, hard-wired to the pins below, or on the SPI controller with
+ *	only the reset and data/command lines on GPIO.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <wiringPi.h>
+#include <wiringPiSPI.h>
+
+#include "lcd128x64.h"
+
+#define delay_ms(x) delay(x)
+
+#define OLED_CMD    0
+#define OLED_DATA   1
+
+// Hardware Pins
+#define OLED_SCL    21
+#define OLED_SDIN   22
+#define OLED_RST    23
+#define OLED_DC     24
+#define OLED_CS     25
+
+#define OLED_CS_Clr()   digitalWrite(OLED_CS, LOW);
+#define OLED_CS_Set()   digitalWrite(OLED_CS, HIGH);
+
+#define OLED_RST_Clr()  digitalWrite(OLED_RST, LOW);
+#define OLED_RST_Set()  digitalWrite(OLED_RST, HIGH);
+
+#define OLED_DC_Clr()   digitalWrite(OLED_DC, LOW);
+#define OLED_DC_Set()   digitalWrite(OLED_DC, HIGH);
+
+#define OLED_SCLK_Clr() digitalWrite(OLED_SCL, LOW);
+#define OLED_SCLK_Set() digitalWrite(OLED_SCL, HIGH);
+
+#define OLED_SDIN_Clr() digitalWrite(OLED_SDIN, LOW);
+#define OLED_SDIN_Set() digitalWrite(OLED_SDIN, HIGH);
+
+
+/*
+ * sendByte:
+ *	Bit-bang a data or command byte to the display.
+ *********************************************************************************
+ */
+static void sendByte (int32 dat, const int32 cmd)
+{
+  int32 i;
+  if(cmd)
+  {
+    OLED_DC_Set();
+  }
+  else
+  {
+    OLED_DC_Clr();
+  }
+  OLED_CS_Clr();
+  for(i=0;i<8;i++)
+  {
+    OLED_SCLK_Clr();
+    if(dat&0x80)
+    {
+      OLED_SDIN_Set();
+    }
+    else
+    {
+      OLED_SDIN_Clr();
+    }
+    OLED_SCLK_Set();
+    dat<<=1;
+  }
+  OLED_CS_Set();
+  OLED_DC_Set();
+}
+
+
+/*
+ * spiCommand: spiData:
+ *	The transport, bit-banged SPI on the pins above.
+ *********************************************************************************
+ */
+static void spiCommand (uint8 c)
+{
+  sendByte (c, OLED_CMD) ;
+}
+
+static void spiData (const uint8 *buf, int32 len)
+{
+  while (len--)
+    sendByte (*buf++, OLED_DATA) ;
+}
+
+const lcd128x64transport lcd128x64spiTransport = { spiCommand, spiData, 1, NULL } ;
+
+
+/*
+ * hwCommand: hwData:
+ *	The transport on the SPI controller. wiringPiSPIDataRW reads back
+ *	into the buffer it sends, so data goes out through a copy, a page
+ *	span at a time.
+ *********************************************************************************
+ */
+static int32 spiChannel ;
+
+static void hwCommand (uint8 c)
+{
+  OLED_DC_Clr() ;
+  wiringPiSPIDataRW (spiChannel, &c, 1) ;
+}
+
+static void hwData (const uint8 *buf, int32 len)
+{
+  uint8 span [LCD_WIDTH + 4] ;
+  int32 n ;
+
+  OLED_DC_Set() ;
+  while (len > 0)
+  {
+    n = (len > (int32)sizeof (span)) ? (int32)sizeof (span) : len ;
+    memcpy (span, buf, n) ;
+    wiringPiSPIDataRW (spiChannel, span, n) ;
+    buf += n ;
+    len -= n ;
+  }
+}
+
+const lcd128x64transport lcd128x64spiHwTransport = { hwCommand, hwData, 1, NULL } ;
+
+
+/*
+ * resetPanel:
+ *	Pulse the reset line.
+ *********************************************************************************
+ */
+static void resetPanel (void)
+{
+  OLED_RST_Set();
+  delay_ms(100);
+  OLED_RST_Clr();
+  delay_ms(100);
+  OLED_RST_Set(); 
+}
+
+
+/*
+ * lcd128x64setup:
+ *	Initialise the display and GPIO, and drive the display through
+ *	them.
+ *********************************************************************************
+ */
+int32 lcd128x64setup (void)
+{
+  wiringPiSetup();
+  pinMode(OLED_SCL, OUTPUT);
+  pinMode(OLED_SDIN, OUTPUT);
+  pinMode(OLED_RST, OUTPUT);
+  pinMode(OLED_DC, OUTPUT);
+  pinMode(OLED_CS, OUTPUT);
+
+  resetPanel () ;
+
+  lcd128x64setTransport (&lcd128x64spiTransport) ;
+  return lcd128x64init () ;
+}
+
+
+/*
+ * lcd128x64setupHw:
+ *	Initialise the display on SPI channel 0 or 1 at speed Hz, CS on
+ *	the channel's CE line, and drive the display through it.
+ *********************************************************************************
+ */
+int32 lcd128x64setupHw (int32 channel, int32 speed)
+{
+  wiringPiSetup();
+  pinMode(OLED_RST, OUTPUT);
+  pinMode(OLED_DC, OUTPUT);
+
+  spiChannel = channel ;
+  if (wiringPiSPISetup (channel, speed) < 0)
+    return -1 ;
+
+  resetPanel () ;
+
+  lcd128x64setTransport (&lcd128x64spiHwTransport) ;
+  return lcd128x64init () ;
+}
@@ -0,0 +1,350 @@
+/*
+ * lcd128x64term.c:
+ *	A terminal transport for lcd128x64, for running without the
+ *	panel: over SSH, or anywhere there is no wiringPi. It plays the
+ *	part of the SH1106, keeping its own display RAM from the commands
+ *	and data it is sent, and at the end of every frame redraws the
+ *	changed part in Unicode braille, one character per 2x4 pixels.
+ *	The characters on the screen are remembered so only cells that
+ *	actually changed are written, and the output is batched into a
+ *	few write () calls per frame.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "lcd128x64.h"
+
+// The controller: 132 columns of RAM, the panel shows 128 from column 2
+#define RAM_WIDTH     132
+#define COL_OFFSET    2
+
+#define TERM_COLS     (LCD_WIDTH / 2)
+#define TERM_ROWS     (LCD_HEIGHT * 8 / 4)
+#define TERM_OUT      4096
+
+static uint8 ram [LCD_HEIGHT][RAM_WIDTH] ;
+static int32 page, column, argBytes ;
+static int32 displayOn, inverse, allOn ;
+
+// Panel columns written since the last frame, per page (lo > hi if none)
+static int32 dirtyLo [LCD_HEIGHT], dirtyHi [LCD_HEIGHT] ;
+
+// Glyph on the screen for every cell, -1 if unknown
+static short shown [TERM_ROWS][TERM_COLS] ;
+static int32 curRow, curCol ;
+static int32 started = 0 ;
+
+static char   out [TERM_OUT] ;
+static int32  outLen ;
+static uint32 termBytes = 0 ;
+
+static pthread_mutex_t statusLock = PTHREAD_MUTEX_INITIALIZER ;
+static char status [128], statusShown [128] ;
+
+
+/*
+ * markAll:
+ *	Everything needs redrawing, as after display on/off or inverse.
+ *********************************************************************************
+ */
+static void markAll (void)
+{
+  int32 p ;
+
+  for (p = 0 ; p < LCD_HEIGHT ; ++p)
+  {
+    dirtyLo [p] = 0 ;
+    dirtyHi [p] = LCD_WIDTH - 1 ;
+  }
+}
+
+
+/*
+ * termCommand: termData:
+ *	The controller side: page and column addressing, display on/off,
+ *	inverse and entire display on. Commands that take an argument
+ *	have it skipped; remapping is left to the driver (hwRemap is 0).
+ *********************************************************************************
+ */
+static void termCommand (uint8 c)
+{
+  if (argBytes > 0)
+  {
+    --argBytes ;
+    return ;
+  }
+
+  if ((c & 0xF8) == 0xB0)
+    page = c & 0x07 ;
+  else if ((c & 0xF0) == 0x10)
+    column = (column & 0x0F) | ((c & 0x0F) << 4) ;
+  else if ((c & 0xF0) == 0x00)
+    column = (column & 0xF0) | c ;
+  else
+  {
+    switch (c)
+    {
+      case 0xAE: case 0xAF: displayOn = c & 1 ; markAll () ; break ;
+      case 0xA6: case 0xA7: inverse   = c & 1 ; markAll () ; break ;
+      case 0xA4: case 0xA5: allOn     = c & 1 ; markAll () ; break ;
+
+      case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xAD:
+      case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        argBytes = 1 ;
+        break ;
+
+      default:
+        break ;
+    }
+  }
+}
+
+static void termData (const uint8 *buf, int32 len)
+{
+  int32 x ;
+
+  for ( ; len-- ; ++column)
+  {
+    if (column >= RAM_WIDTH)
+      break ;
+    ram [page][column] = *buf++ ;
+
+    x = column - COL_OFFSET ;
+    if ((x < 0) || (x >= LCD_WIDTH))
+      continue ;
+    if (x < dirtyLo [page]) dirtyLo [page] = x ;
+    if (x > dirtyHi [page]) dirtyHi [page] = x ;
+  }
+}
+
+
+/*
+ * flushOut: emit:
+ *	Batch terminal output, writing it out when the buffer is full and
+ *	at the end of a frame.
+ *********************************************************************************
+ */
+static void flushOut (void)
+{
+  int32 done = 0, n ;
+
+  while (done < outLen)
+  {
+    n = (int32)write (STDOUT_FILENO, out + done, outLen - done) ;
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue ;
+      break ;
+    }
+    done += n ;
+  }
+
+  termBytes += outLen ;
+  outLen = 0 ;
+}
+
+static void emit (const char *s, int32 n)
+{
+  if (outLen + n > TERM_OUT)
+    flushOut () ;
+  memcpy (out + outLen, s, n) ;
+  outLen += n ;
+}
+
+
+/*
+ * glyph:
+ *	The braille dots for the 2x4 pixels of a cell: the left column is
+ *	dots 1, 2, 3, 7 and the right 4, 5, 6, 8, top to bottom.
+ *********************************************************************************
+ */
+static int32 glyph (int32 cx, int32 cy)
+{
+  uint8 l, r ;
+
+  if (!displayOn)
+    return 0 ;
+  if (allOn)
+    return 0xFF ;
+
+  l = ram [cy / 2][COL_OFFSET + cx * 2] ;
+  r = ram [cy / 2][COL_OFFSET + cx * 2 + 1] ;
+  if (inverse)
+  {
+    l = (uint8)~l ;
+    r = (uint8)~r ;
+  }
+  l = (uint8)((l >> ((cy & 1) * 4)) & 0x0F) ;
+  r = (uint8)((r >> ((cy & 1) * 4)) & 0x0F) ;
+
+  return (l & 0x07) | ((l & 0x08) << 3) | ((r & 0x07) << 3) | ((r & 0x08) << 4) ;
+}
+
+
+/*
+ * termPresent:
+ *	Write the cells that changed since the last frame, and the status
+ *	line if it changed.
+ *********************************************************************************
+ */
+static void termPresent (void)
+{
+  char buf [32] ;
+  int32 p, cy, cx, g, n ;
+
+  if (!started)
+  {
+    emit ("\033[2J\033[?25l", 10) ;
+    memset (shown, 0xFF, sizeof (shown)) ;
+    curRow  = -1 ;
+    started = 1 ;
+  }
+
+  for (p = 0 ; p < LCD_HEIGHT ; ++p)
+  {
+    if (dirtyLo [p] > dirtyHi [p])
+      continue ;
+
+    for (cy = p * 2 ; cy < p * 2 + 2 ; ++cy)
+      for (cx = dirtyLo [p] / 2 ; cx <= dirtyHi [p] / 2 ; ++cx)
+      {
+        if ((g = glyph (cx, cy)) == shown [cy][cx])
+          continue ;
+        shown [cy][cx] = (short)g ;
+
+        if ((cy != curRow) || (cx != curCol))
+        {
+          n = snprintf (buf, sizeof (buf), "\033[%d;%dH", cy + 1, cx + 1) ;
+          emit (buf, n) ;
+          curRow = cy ;
+        }
+        buf [0] = (char)0xE2 ;
+        buf [1] = (char)(0xA0 | (g >> 6)) ;
+        buf [2] = (char)(0x80 | (g & 0x3F)) ;
+        emit (buf, 3) ;
+        curCol = cx + 1 ;
+      }
+
+    dirtyLo [p] = LCD_WIDTH ;
+    dirtyHi [p] = -1 ;
+  }
+
+  pthread_mutex_lock (&statusLock) ;
+  if (strcmp (status, statusShown) != 0)
+  {
+    n = snprintf (buf, sizeof (buf), "\033[%d;1H", TERM_ROWS + 2) ;
+    emit (buf, n) ;
+    emit (status, (int32)strlen (status)) ;
+    emit ("\033[K", 3) ;
+    strcpy (statusShown, status) ;
+    curRow = -1 ;
+  }
+  pthread_mutex_unlock (&statusLock) ;
+
+  flushOut () ;
+}
+
+const lcd128x64transport lcd128x64termTransport = { termCommand, termData, 0, termPresent } ;
+
+
+/*
+ * termRestore:
+ *	Put the cursor back below the display on exit.
+ *********************************************************************************
+ */
+static void termRestore (void)
+{
+  char buf [32] ;
+  int32 n ;
+
+  if (!started)
+    return ;
+
+  n = snprintf (buf, sizeof (buf), "\033[%d;1H\033[?25h\n", TERM_ROWS + 3) ;
+  emit (buf, n) ;
+  flushOut () ;
+}
+
+
+/*
+ * lcd128x64termSetup:
+ *	Drive the terminal instead of the panel. It needs 64 columns and
+ *	18 lines; the display is drawn at the top left, the status line
+ *	below it.
+ *********************************************************************************
+ */
+int32 lcd128x64termSetup (void)
+{
+  static int32 registered = 0 ;
+  int32 p ;
+
+  memset (ram, 0, sizeof (ram)) ;
+  page = column = argBytes = 0 ;
+  displayOn = inverse = allOn = 0 ;
+  for (p = 0 ; p < LCD_HEIGHT ; ++p)
+  {
+    dirtyLo [p] = LCD_WIDTH ;
+    dirtyHi [p] = -1 ;
+  }
+  started = 0 ;
+  outLen  = 0 ;
+
+  if (!registered)
+  {
+    atexit (termRestore) ;
+    registered = 1 ;
+  }
+
+  lcd128x64setTransport (&lcd128x64termTransport) ;
+  return lcd128x64init () ;
+}
+
+
+/*
+ * lcd128x64termStatus:
+ *	Set the line shown below the display; it is drawn with the next
+ *	frame. Safe to call from any thread.
+ *********************************************************************************
+ */
+void lcd128x64termStatus (const char *text)
+{
+  pthread_mutex_lock (&statusLock) ;
+  snprintf (status, sizeof (status), "%s", text) ;
+  pthread_mutex_unlock (&statusLock) ;
+}
+
+
+/*
+ * lcd128x64termBytes:
+ *	Return the number of bytes written to the terminal so far.
+ *********************************************************************************
+ */
+uint32 lcd128x64termBytes (void)
+{
+  return termBytes ;
+}
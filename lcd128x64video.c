@@ -0,0 +1,187 @@
+/*
+ * lcd128x64video.c:
+ *	Play 1-bit videos (see lcd128x64video.h) from a memory-mapped
+ *	file. Every frame is XORed straight into the framebuffer and only
+ *	the bytes it changed are flushed, paced against the monotonic
+ *	clock. When playback falls behind, frames are still decoded but
+ *	not sent, so it catches up without losing the picture.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lcd128x64video.h"
+
+
+/*
+ * get16: get32:
+ *	Little-endian numbers from the file.
+ *********************************************************************************
+ */
+static uint32 get16 (const uint8 *p)
+{
+  return p [0] | (p [1] << 8) ;
+}
+
+static uint32 get32 (const uint8 *p)
+{
+  return p [0] | (p [1] << 8) | (p [2] << 16) | ((uint32)p [3] << 24) ;
+}
+
+
+/*
+ * elapsedMs: sleepUntil:
+ *	Time since start, and wait for start + ms.
+ *********************************************************************************
+ */
+static uint32 elapsedMs (const struct timespec *start)
+{
+  struct timespec now ;
+
+  clock_gettime (CLOCK_MONOTONIC, &now) ;
+  return (uint32)((now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000) ;
+}
+
+static void sleepUntil (const struct timespec *start, uint32 ms)
+{
+  struct timespec t = *start ;
+
+  t.tv_sec  += ms / 1000 ;
+  t.tv_nsec += (long)(ms % 1000) * 1000000 ;
+  if (t.tv_nsec >= 1000000000)
+  {
+    t.tv_nsec -= 1000000000 ;
+    ++t.tv_sec ;
+  }
+
+  while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR)
+    ;
+}
+
+
+/*
+ * lcd128x64playVideo:
+ *	Play a video with its top left corner at x,y, which must be on a
+ *	page boundary. Returns once the last frame has been shown, or -1
+ *	if the file can't be read or is corrupt. stats may be NULL.
+ *********************************************************************************
+ */
+int32 lcd128x64playVideo (const char *fileName, int32 x, int32 y, lcd128x64videoStats *stats)
+{
+  lcd128x64videoStats st ;
+  struct timespec start ;
+  struct stat sb ;
+  const uint8 *file, *p, *end, *next ;
+  uint32 w, h, frames, i, size, at, bytes0 ;
+  int32 fd, result = 0 ;
+
+  memset (&st, 0, sizeof (st)) ;
+
+  if ((fd = open (fileName, O_RDONLY)) < 0)
+    return -1 ;
+  if ((fstat (fd, &sb) < 0) || (sb.st_size < LVID_HEADER))
+  {
+    close (fd) ;
+    return -1 ;
+  }
+
+  file = mmap (NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0) ;
+  close (fd) ;
+  if (file == MAP_FAILED)
+    return -1 ;
+
+  end    = file + sb.st_size ;
+  w      = get16 (file + 4) ;
+  h      = get16 (file + 6) ;
+  frames = get32 (file + 8) ;
+
+  if ((memcmp (file, "LVID", 4) != 0) || (w == 0) || (h == 0))
+  {
+    munmap ((void *)file, sb.st_size) ;
+    return -1 ;
+  }
+
+  bytes0 = lcd128x64bytesSent () ;
+  clock_gettime (CLOCK_MONOTONIC, &start) ;
+
+  p = file + LVID_HEADER ;
+  for (i = 0 ; i < frames ; ++i)
+  {
+    if (end - p < LVID_RECORD)
+    {
+      result = -1 ;
+      break ;
+    }
+
+    at   = get32 (p + 4) ;
+    size = get32 (p + 8) ;
+    if (size > (uint32)(end - p - LVID_RECORD))
+    {
+      result = -1 ;
+      break ;
+    }
+    next = p + LVID_RECORD + size ;
+
+    if (p [0] == LVID_KEY)
+      lcd128x64rectangle (x, y, x + w - 1, y + h - 1, 0, 1) ;
+
+    if (lcd128x64putdelta (x, y, w, h, p + LVID_RECORD, size) < 0)
+    {
+      result = -1 ;
+      break ;
+    }
+    ++st.frames ;
+
+    // Behind if the next frame is already due: skip sending this one
+
+    if ((i + 1 < frames) && (end - next >= LVID_RECORD) && (get32 (next + 4) <= elapsedMs (&start)))
+      ++st.dropped ;
+    else
+    {
+      if (at > elapsedMs (&start))
+        sleepUntil (&start, at) ;
+      lcd128x64flush () ;
+      ++st.shown ;
+    }
+
+    p = next ;
+  }
+
+  st.seconds = elapsedMs (&start) / 1000.0 ;
+  st.bytes   = lcd128x64bytesSent () - bytes0 ;
+  if (st.seconds > 0)
+    st.fps = st.shown / st.seconds ;
+  if (st.shown > 0)
+    st.bytesPerFrame = (double)st.bytes / st.shown ;
+
+  if (stats != NULL)
+    *stats = st ;
+
+  munmap ((void *)file, sb.st_size) ;
+  return result ;
+}
@@ -0,0 +1,79 @@
+/*
+ * lcd128x64video.h:
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ * This file is part of wiringPi:
+ *	https://projects.drogon.net/raspberry-pi/wiringpi/
+ *
+ *    wiringPi is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    wiringPi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with wiringPi.  If not, see <http://www.gnu.org/licenses/>.
+ ***********************************************************************
+ */
+#ifndef __LCD128X64VIDEO_H_
+#define __LCD128X64VIDEO_H_
+
+#include "lcd128x64.h"
+
+// Video files, all numbers little-endian:
+//	header  "LVID", uint16 width, uint16 height, uint32 frames, uint32 0
+//	frame   uint8 type, 3 bytes 0, uint32 time in ms from the start,
+//	        uint32 size, then size bytes of delta
+//	Frames are page-major like packed bitmaps. A 'D' frame is XORed
+//	into the previous one (see lcd128x64putdelta), a 'K' frame is a
+//	delta against a blank frame so playback can start there.
+#define	LVID_HEADER   16
+#define	LVID_RECORD   12
+#define	LVID_KEY      'K'
+#define	LVID_DELTA    'D'
+
+// Largest delta lcd128x64deltaEncode can produce for len bytes
+#define	LVID_MAX_DELTA(len)   ((len) + (len) / 2 + 8)
+
+// Called by lcd128x64deltaRuns for each run of n changed bytes, to be
+//	XORed in at byte pos of the frame
+typedef void (*lcd128x64deltaRunFn) (int32 pos, const uint8 *bytes, int32 n, void *arg) ;
+
+typedef struct lcd128x64videoStats
+{
+  uint32 frames ;		// frames decoded
+  uint32 shown ;		// frames sent to the panel
+  uint32 dropped ;		// frames decoded but never sent
+  uint32 bytes ;		// bytes sent to the panel
+  double seconds ;
+  double fps ;			// frames shown per second
+  double bytesPerFrame ;	// bytes sent per frame shown
+} lcd128x64videoStats ;
+
+typedef struct lcd128x64recordStats
+{
+  uint32 frames ;		// frames written
+  uint32 dropped ;		// frames dropped with the queue full
+  uint32 keyframes ;
+  uint32 bytes ;		// file size
+  double nsPerFrame ;		// time the recorder adds to each frame
+} lcd128x64recordStats ;
+
+extern int32  lcd128x64deltaEncode       (const uint8 *prev, const uint8 *cur, \
+                                            int32 len, uint8 *out) ;
+extern int32  lcd128x64deltaApply        (uint8 *buf, int32 len, \
+                                            const uint8 *delta, int32 size) ;
+extern int32  lcd128x64deltaRuns         (const uint8 *delta, int32 size, \
+                                            int32 len, lcd128x64deltaRunFn fn, \
+                                            void *arg) ;
+extern int32  lcd128x64playVideo         (const char *fileName, int32 x, int32 y, \
+                                            lcd128x64videoStats *stats) ;
+extern int32  lcd128x64recordStart       (const char *fileName, int32 keyInterval) ;
+extern void   lcd128x64recordStop        (lcd128x64recordStats *stats) ;
+
+#endif
@@ -11,7 +11,8 @@
   功能描述   : 点阵贪吃蛇游戏
   接口函数   :
               snake_game_init         (int32 scnt, SNAKE_DIR sdir, \
-                                       int32 sstep, int32 speed);
+                                       int32 sstep, int32 speed, \
+                                       uint64 seed, uint64 stream);
               snake_move_control      (SNAKE_DIR KEY);
               snake_get_score         (void);
               snake_get_speed         (void);
@@ -23,6 +24,14 @@
               snake_get_dir           (void);
               snake_set_dir           (SNAKE_DIR sdir);
               snake_set_crosswall     (int32 crosswall);
+              snake_rand_advance      (uint64 delta);
+              snake_get_body          (uint16* cells, int32 max);
+              snake_set_renderer      (const SNAKE_RENDERER* render, \
+                                       void* arg);
+              snake_game_size         (void);
+              snake_game_create       (void* mem, int32 size);
+              snake_game_destroy      (SNAKE_GAME* game);
+              以及上面各函数带_r后缀、第一个参数为SNAKE_GAME*的版本
   修改历史   :
   1.日    期   : 2015年9月22日,星期二
     作    者   : 胡椒小兄弟
@@ -36,42 +45,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
-#include <sys/time.h>
-#include "lcd128x64.h"
+#include <stdint.h>
 #include "lcd_snake.h"
 
-/*----------------------------------------------*
- * 自定义数据类型                               *
- *----------------------------------------------*/
-typedef enum snake_propy//属性
-{
-    PR_FOOD = 0,        //0食物
-    PR_HEAD,            //1蛇头
-    PR_BODY,            //2身体
-    PR_WALL,            //3墙壁
-    PR_NULL             //空白
-} SNAKE_PROPY;
-
-typedef enum snake_col//颜色
-{
-    COL_BLACK = 0,      //0黑色表示不显示
-    COL_WHITE,          //1白色表示显示
-} SNAKE_COL;
-
-typedef struct snake_point//位置
-{
-    int32               PT_LOCX;//X坐标
-    int32               PT_LOCY;//Y坐标
-    SNAKE_COL           PT_COLOR;
-} SNAKE_POINT;
-
-typedef struct snake//蛇
-{
-    SNAKE_POINT         S_POINT;//坐标
-    SNAKE_PROPY         S_PROPERTY;//属性
-} SNAKE;
-
 /*----------------------------------------------*
  * 宏定义                                       *
  *----------------------------------------------*/
@@ -79,484 +55,989 @@ typedef struct snake//蛇
 #define SnakePointY     SnakePointX//蛇身点大小
 #define SnakeStepX      (SnakeMaxX / SnakePointX)//移动步数
 #define SnakeStepY      (SnakeMaxY / SnakePointY)//移动步数
+#define SNAKE_RING(g,i) (((g)->G_HEAD + (i)) % SnakeMaxLen)//从蛇头数起的第i节在环形缓冲区中的下标
+#ifdef SNAKE_PACKED_BODY
+#define SNAKE_LINK(g,i) (((g)->G_LINKS[SNAKE_RING(g,i) / 4] >> (SNAKE_RING(g,i) % 4 * 2)) & 3)//第i+1节到第i节的方向
+#else
+#define SNAKE_AT(g,i)   (g)->G_BODY[SNAKE_RING(g,i)]//从蛇头数起的第i节
+#endif
+#define SnakeCells      (SnakeStepX * SnakeStepY)//棋盘格数
+#define SNAKE_CELL(x,y) ((y) * SnakeStepX + (x))//格子编号
+#define SNAKE_X(n)      ((n) % SnakeStepX)//格子的X坐标
+#define SNAKE_Y(n)      ((n) / SnakeStepX)//格子的Y坐标
+#define SNAKE_OCCUPIED(g,n) (((g)->G_OCC[(n) / 32] >> ((n) % 32)) & 1)//格子是否被占用
+#define SnakeRandMult   6364136223846793005ULL//PCG32的乘数
+#define SnakeChangeMax  8//变化列表长度，每步最多4个格子变化
+#define SnakeNoFood     SnakeCells//G_FOOD的值，表示棋盘上没有食物
+
+#if ((SnakeMaxX / SnakePtSize) * (SnakeMaxY / SnakePtSize)) > 65535
+#error "格子编号是uint16，棋盘最多65535格"
+#endif
 
 /*----------------------------------------------*
- * 内部静态变量                                 *
+ * 自定义数据类型                               *
  *----------------------------------------------*/
-static SNAKE        SNAKE_FOOD;//食物
-static SNAKE        GAME_SNAKE[SnakeMaxLen];//蛇
-//static SNAKE        GAME_MAP[SnakeMaxLen];//地图
-static int32        SnakeCount = 3;//蛇身长度
-static SNAKE_DIR    SnakeDir = DR_RIGHT;//蛇头移动方向
-static SNAKE_LIFE   SnakeLife = LF_LIVE;//游戏进程
-static int32        SnakeScore = 0;//得分
-static int32        SnakeSpeed = 10;//速度
-static int32        SCORE_STEP = 10;//每吃到10个食物速度加快一级
-static int32        SCROSS_WALL = 1;//允许越界
-
-/*****************************************************************************
- 函 数 名  : snake_draw_point
- 功能描述  : 使用缩放过后的DPI绘制一个蛇身点
- 输入参数  : SNAKE_POINT* s_point  
- 输出参数  : 无
- 返 回 值  : 成功返回0，失败返回1
- 函数说明  : 
-*****************************************************************************/
-int32 snake_draw_point(SNAKE_POINT* s_point)
+typedef struct snake_change//一个变化了的格子
 {
-    int32 x = 0, y = 0, col = 0;
+    uint16              C_CELL;//格子编号
+    uint8               C_PROPERTY;//新的属性(SNAKE_PROPY)
+} SNAKE_CHANGE;
     
-    if(s_point == RTN_NULL)
-        return RTN_ERR;
+typedef struct snake_rand//PCG32随机数发生器
+{
+    uint64              R_STATE;//状态
+    uint64              R_INC;//增量，由序列号决定，必须是奇数
+} SNAKE_RAND;
+    
+struct snake_game//一局游戏的全部状态，各局之间互不影响
+{
+    SNAKE_RAND          G_RAND;//本局游戏的随机数发生器
+    const SNAKE_RENDERER* G_RENDER;//显示游戏的方式
+    void*               G_RENDERARG;//传给G_RENDER的参数
+    int32               G_COUNT;//蛇身长度
+    SNAKE_DIR           G_DIR;//蛇头移动方向
+    SNAKE_LIFE          G_LIFE;//游戏进程
+    int32               G_SCORE;//得分
+    int32               G_SPEED;//速度
+    int32               G_SCSTEP;//每吃到G_SCSTEP个食物速度加快一级
+    int32               G_CROSSWALL;//允许越界
+    int32               G_OWNED;//内存由snake_game_create分配，销毁时释放
+    int32               G_HEAD;//蛇头在环形缓冲区中的下标
+    int32               G_FREECNT;//空白格子数
+    int32               G_CHANGECNT;//变化个数
+    uint16              G_FOOD;//食物所在的格子，没有时为SnakeNoFood
+    uint32              G_OCC[(SnakeCells + 31) / 32];//占用位图，蛇身和墙壁为1
+#ifdef SNAKE_PACKED_BODY
+    //蛇身只记蛇头和蛇尾的格子，以及每相邻两节之间的方向，每节2位
+    uint16              G_HEADCELL;//蛇头所在的格子
+    uint16              G_TAILCELL;//蛇尾所在的格子
+    uint8               G_LINKS[(SnakeMaxLen + 3) / 4];//方向的环形缓冲区，第i个在SNAKE_LINK(g,i)
+#else
+    uint16              G_BODY[SnakeMaxLen];//蛇，存格子编号的环形缓冲区，第i节在SNAKE_AT(g,i)
+#endif
+    uint16              G_FREE[SnakeCells];//空白格子的稠密集合，前G_FREECNT个有效
+    uint16              G_FREEPOS[SnakeCells];//每个空白格子在G_FREE中的下标
+    SNAKE_CHANGE        G_CHANGES[SnakeChangeMax];//还没有画出来的变化
+};
     
-    x = s_point->PT_LOCX;
-    y = s_point->PT_LOCY;
-    col = s_point->PT_COLOR;
+/*----------------------------------------------*
+ * 内部静态变量                                 *
+ *----------------------------------------------*/
+//不带_r的函数使用的默认游戏
+static SNAKE_GAME   SnakeGame;
+static int32        SnakeGameReady = 0;//SnakeGame是否已经设置了默认值
     
-    if((x < 0) || (x >= SnakeStepX) || (y < 0) || (y >= SnakeStepY))
-        return RTN_ERR;
+//每个方向上相邻格子的编号差，以及在边上越界时从另一边接上的编号差
+static const int32  SNAKE_STEP[4] = {-SnakeStepX, SnakeStepX, -1, 1};
+static const int32  SNAKE_WRAP[4] = {SnakeCells - SnakeStepX, SnakeStepX - SnakeCells, \
+                                     SnakeStepX - 1, 1 - SnakeStepX};
+static const SNAKE_DIR SNAKE_BACK[4] = {DR_DOWN, DR_UP, DR_RIGHT, DR_LEFT};//反方向
     
-    x = x * SnakePointX;
-    y = y * SnakePointY;
+//什么都不显示，用于模拟
+const SNAKE_RENDERER snake_null_renderer = {RTN_NULL, RTN_NULL, RTN_NULL};
     
-    if(SnakePointX != 1)//画一个矩形代表缩放过后的点
-        lcd128x64rectangle(x, y, x+SnakePointX-1, y+SnakePointY-1, col, 1);
-    else//为了加快速度，宽度为1不缩放，直接画点
-        lcd128x64point(x, y, col);
-    return RTN_OK;
+/*****************************************************************************
+ 函 数 名  : snake_game_defaults
+ 功能描述  : 给一局游戏设置默认值
+ 输入参数  : SNAKE_GAME* game
+ 输出参数  : 无
+ 返 回 值  : 
+ 函数说明  : game之前要清零，G_OWNED由调用者设置
+*****************************************************************************/
+static void snake_game_defaults(SNAKE_GAME* game)
+{
+    game->G_RENDER = &snake_null_renderer;
+    game->G_RENDERARG = RTN_NULL;
+    game->G_COUNT = 3;
+    game->G_DIR = DR_RIGHT;
+    game->G_LIFE = LF_LIVE;
+    game->G_SCORE = 0;
+    game->G_SPEED = 10;
+    game->G_SCSTEP = 10;
+    game->G_CROSSWALL = 1;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_get_point
- 功能描述  : 获取屏幕上某个点的颜色
- 输入参数  : SNAKE_POINT* s_point  
+ 函 数 名  : snake_default
+ 功能描述  : 取得默认游戏
+ 输入参数  : 无
  输出参数  : 无
- 返 回 值  : 返回指定的点的颜色(1或0)
- 函数说明  : 
+ 返 回 值  : 默认游戏
+ 函数说明  : 第一次使用时设置默认值。默认游戏只有一个，不能在多个线程中
+             同时使用；需要多局游戏或者多线程时用snake_game_create
 *****************************************************************************/
-int32 snake_get_point(SNAKE_POINT* s_point)
+static SNAKE_GAME* snake_default(void)
 {
-    int32 x = 0, y = 0;
+    if(!SnakeGameReady)
+    {
+        snake_game_defaults(&SnakeGame);
+        SnakeGameReady = 1;
+    }
+    return &SnakeGame;
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_game_size
+ 功能描述  : 一局游戏需要的内存大小
+ 输入参数  : 无
+ 输出参数  : 无
+ 返 回 值  : 字节数
+ 函数说明  : 用于给snake_game_create准备内存
+*****************************************************************************/
+int32 snake_game_size(void)
+{
+    return (int32)sizeof(SNAKE_GAME);
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_game_create
+ 功能描述  : 新建一局游戏
+ 输入参数  : void* mem:放游戏的内存，为NULL时由本函数分配
+             int32 size:mem的字节数
+ 输出参数  : 无
+ 返 回 值  : 成功返回游戏，mem不够大、没有对齐或者分配失败返回RTN_NULL
+ 函数说明  : mem至少要有snake_game_size()个字节，并且按8字节对齐(malloc得
+             到的内存都可以)，这样可以从内存池里一次给很多局游戏分配内存。
+             新游戏用snake_game_init_r开始
+*****************************************************************************/
+SNAKE_GAME* snake_game_create(void* mem, int32 size)
+{
+    SNAKE_GAME* game = RTN_NULL;
     
-    if(s_point == RTN_NULL)
-        return RTN_ERR;
+    if(mem == RTN_NULL)
+    {
+        if((game = (SNAKE_GAME*)malloc(sizeof(SNAKE_GAME))) == RTN_NULL)
+            return RTN_NULL;
+    }
+    else
+    {
+        if((size < (int32)sizeof(SNAKE_GAME)) || (((uintptr_t)mem & 7) != 0))
+            return RTN_NULL;//不够大或者没有按8字节对齐
+        game = (SNAKE_GAME*)mem;
+    }
     
-    x = s_point->PT_LOCX;
-    y = s_point->PT_LOCY;
+    memset(game, 0, sizeof(SNAKE_GAME));
+    snake_game_defaults(game);
+    game->G_OWNED = (mem == RTN_NULL);
     
-    if((x < 0) || (x >= SnakeStepX) || (y < 0) || (y >= SnakeStepY))
-        return RTN_ERR;
+    return game;
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_game_destroy
+ 功能描述  : 销毁一局游戏
+ 输入参数  : SNAKE_GAME* game
+ 输出参数  : 无
+ 返 回 值  : 无
+ 函数说明  : 只释放snake_game_create分配的内存，调用者提供的内存由调用者
+             自己处理
+*****************************************************************************/
+void snake_game_destroy(SNAKE_GAME* game)
+{
+    if((game != RTN_NULL) && game->G_OWNED)
+        free(game);
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_set_renderer_r
+ 功能描述  : 设置显示游戏的方式
+ 输入参数  : SNAKE_GAME* game
+             const SNAKE_RENDERER* render:为NULL时什么都不显示
+             void* arg:原样传给render的各个函数
+ 输出参数  : 无
+ 返 回 值  : 无
+ 函数说明  : 游戏本身不依赖任何显示，格子、分数和游戏结束都通过render通知
+*****************************************************************************/
+void snake_set_renderer_r(SNAKE_GAME* game, const SNAKE_RENDERER* render, void* arg)
+{
+    game->G_RENDER = (render == RTN_NULL) ? &snake_null_renderer : render;
+    game->G_RENDERARG = arg;
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_draw_changes
+ 功能描述  : 画出变化列表中的格子，然后清空列表
+ 输入参数  : SNAKE_GAME* game
+ 输出参数  : 无
+ 返 回 值  : 
+ 函数说明  : 每步只画变化了的几个格子:新蛇头、变成蛇身的旧蛇头、让出来的
+             蛇尾和新食物，画的时间与蛇身长度无关。怎么画由G_RENDER决定
+*****************************************************************************/
+static void snake_draw_changes(SNAKE_GAME* game)
+{
+    int32 i = 0;
     
-    x = x * SnakePointX;
-    y = y * SnakePointY;
+    if(game->G_RENDER->RD_CELL != RTN_NULL)
+    {
+        for(i=0; i<game->G_CHANGECNT; i++)
+            game->G_RENDER->RD_CELL(game->G_RENDERARG, SNAKE_X(game->G_CHANGES[i].C_CELL), \
+                SNAKE_Y(game->G_CHANGES[i].C_CELL), \
+                (SNAKE_PROPY)game->G_CHANGES[i].C_PROPERTY);
+    }
+    game->G_CHANGECNT = 0;
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_game_over
+ 功能描述  : 结束游戏
+ 输入参数  : SNAKE_GAME* game
+             SNAKE_LIFE life:LF_DIE或LF_WIN
+ 输出参数  : 无
+ 返 回 值  : 
+ 函数说明  : 先画出还没画的格子，再通知游戏结束
+*****************************************************************************/
+static void snake_game_over(SNAKE_GAME* game, SNAKE_LIFE life)
+{
+    game->G_LIFE = life;
+    snake_draw_changes(game);
+    if(game->G_RENDER->RD_OVER != RTN_NULL)
+        game->G_RENDER->RD_OVER(game->G_RENDERARG, life);
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_set_cell
+ 功能描述  : 设置一个格子的属性，同时更新占用位图
+ 输入参数  : SNAKE_GAME* game
+             int32 n:格子编号
+             SNAKE_PROPY spropy:格子的属性
+ 输出参数  : 无
+ 返 回 值  : 
+ 函数说明  : 蛇头、蛇身和墙壁算作占用，食物和空白不算；空白格子另外记在
+             G_FREE集合里，加入和移除都是O(1)。格子的属性不另外保存，
+             由占用位图和G_FOOD就能知道一个格子是否空白。格子同时记入
+             变化列表，由snake_draw_changes画出来
+*****************************************************************************/
+static void snake_set_cell(SNAKE_GAME* game, int32 n, SNAKE_PROPY spropy)
+{
+    int32 last = 0, was_free = 0;
+    
+    was_free = !SNAKE_OCCUPIED(game, n) && (n != game->G_FOOD);
+    if(was_free && (spropy != PR_NULL))
+    {//从空白集合中移除:用最后一个元素填上它的位置
+        last = game->G_FREE[--game->G_FREECNT];
+        game->G_FREE[game->G_FREEPOS[n]] = last;
+        game->G_FREEPOS[last] = game->G_FREEPOS[n];
+    }
+    else if(!was_free && (spropy == PR_NULL))
+    {//加入空白集合末尾
+        game->G_FREE[game->G_FREECNT] = (uint16)n;
+        game->G_FREEPOS[n] = (uint16)game->G_FREECNT++;
+    }
     
-    /*if(lcd128x64getpoint(x, y))
-        s_point->PT_COLOR = COL_WHITE;
+    if(spropy == PR_FOOD)
+        game->G_FOOD = (uint16)n;
+    else if(n == game->G_FOOD)
+        game->G_FOOD = SnakeNoFood;//食物被吃掉了
+    
+    if(game->G_CHANGECNT >= SnakeChangeMax)
+        snake_draw_changes(game);//列表满了先画掉
+    game->G_CHANGES[game->G_CHANGECNT].C_CELL = (uint16)n;
+    game->G_CHANGES[game->G_CHANGECNT].C_PROPERTY = (uint8)spropy;
+    game->G_CHANGECNT++;
+    
+    if((spropy == PR_HEAD) || (spropy == PR_BODY) || (spropy == PR_WALL))
+        game->G_OCC[n / 32] |= (1u << (n % 32));
     else
-        s_point->PT_COLOR = COL_BLACK;
+        game->G_OCC[n / 32] &= ~(1u << (n % 32));
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_next_cell
+ 功能描述  : 求一个格子在某个方向上的相邻格子
+ 输入参数  : int32 n:格子编号
+             SNAKE_DIR dir:方向
+ 输出参数  : int32* wrapped:越过边界从另一边接上时为1
+ 返 回 值  : 相邻格子的编号
+ 函数说明  : 编号差是预先算好的，只需判断是否在边上
+*****************************************************************************/
+static int32 snake_next_cell(int32 n, SNAKE_DIR dir, int32* wrapped)
+{
+    int32 edge = 0;
     
-    return s_point->PT_COLOR;*/
+    switch(dir)
+    {
+        case DR_UP://上
+            {edge = (SNAKE_Y(n) == 0); break;}
+        case DR_DOWN://下
+            {edge = (SNAKE_Y(n) == SnakeStepY - 1); break;}
+        case DR_LEFT://左
+            {edge = (SNAKE_X(n) == 0); break;}
+        default://右
+            {edge = (SNAKE_X(n) == SnakeStepX - 1); dir = DR_RIGHT; break;}
+    }
     
-    return(lcd128x64getpoint(x, y));
+    *wrapped = edge;
+    return n + (edge ? SNAKE_WRAP[dir] : SNAKE_STEP[dir]);
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_body_reset
+ 功能描述  : 让蛇身只剩一节
+ 输入参数  : SNAKE_GAME* game
+             int32 n:这一节所在的格子
+ 输出参数  : 无
+ 返 回 值  : 
+ 函数说明  : 蛇身有两种存法:默认每节存一个格子编号；定义了SNAKE_PACKED_BODY
+             时只存蛇头、蛇尾和每节2位的方向，蛇很长时省内存。下面几个函数
+             对两种存法都适用，G_COUNT由调用者维护
+*****************************************************************************/
+static void snake_body_reset(SNAKE_GAME* game, int32 n)
+{
+    game->G_HEAD = 0;
+#ifdef SNAKE_PACKED_BODY
+    game->G_HEADCELL = (uint16)n;
+    game->G_TAILCELL = (uint16)n;
+#else
+    game->G_BODY[0] = (uint16)n;
+#endif
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_body_head
+ 功能描述  : 蛇头所在的格子
+ 输入参数  : const SNAKE_GAME* game
+ 输出参数  : 无
+ 返 回 值  : 格子编号
+ 函数说明  : 
+*****************************************************************************/
+static int32 snake_body_head(const SNAKE_GAME* game)
+{
+#ifdef SNAKE_PACKED_BODY
+    return game->G_HEADCELL;
+#else
+    return SNAKE_AT(game, 0);
+#endif
 }
 
 /*****************************************************************************
- 函 数 名  : snake_get_randxy
- 功能描述  : 生成一个随机的坐标点
- 输入参数  : SNAKE_POINT* s_point  
+ 函 数 名  : snake_body_tail
+ 功能描述  : 蛇尾所在的格子
+ 输入参数  : const SNAKE_GAME* game
  输出参数  : 无
- 返 回 值  : 成功返回改点，失败返回NULL
+ 返 回 值  : 格子编号
  函数说明  : 
 *****************************************************************************/
-void* snake_get_randxy(SNAKE_POINT* s_point)
+static int32 snake_body_tail(const SNAKE_GAME* game)
 {
-    struct timeval tpstart;
-    uint32 sseed = 0;
+#ifdef SNAKE_PACKED_BODY
+    return game->G_TAILCELL;
+#else
+    return SNAKE_AT(game, game->G_COUNT-1);
+#endif
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_body_push
+ 功能描述  : 蛇头向dir方向前进到格子n
+ 输入参数  : SNAKE_GAME* game
+             int32 n:新的蛇头格子
+             SNAKE_DIR dir:前进的方向
+ 输出参数  : 无
+ 返 回 值  : 
+ 函数说明  : 
+*****************************************************************************/
+static void snake_body_push(SNAKE_GAME* game, int32 n, SNAKE_DIR dir)
+{
+    int32 h = (game->G_HEAD + SnakeMaxLen - 1) % SnakeMaxLen;
     
-    if(s_point == RTN_NULL)
-        return RTN_NULL;
+    game->G_HEAD = h;
+#ifdef SNAKE_PACKED_BODY
+    game->G_LINKS[h / 4] &= (uint8)~(3 << (h % 4 * 2));
+    game->G_LINKS[h / 4] |= (uint8)(dir << (h % 4 * 2));
+    game->G_HEADCELL = (uint16)n;
+    if(game->G_COUNT == 0)
+        game->G_TAILCELL = (uint16)n;//只有一节时蛇头就是蛇尾
+#else
+    (void)dir;
+    game->G_BODY[h] = (uint16)n;
+#endif
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_body_pop
+ 功能描述  : 去掉蛇尾的一节
+ 输入参数  : SNAKE_GAME* game
+ 输出参数  : 无
+ 返 回 值  : 
+ 函数说明  : 要在G_COUNT减1之前调用
+*****************************************************************************/
+static void snake_body_pop(SNAKE_GAME* game)
+{
+#ifdef SNAKE_PACKED_BODY
+    int32 wrapped = 0;
+    
+    if(game->G_COUNT < 2)
+        return;//只有一节，新的蛇尾就是随后放入的蛇头
+    
+    //新的蛇尾是旧蛇尾沿着最后一个方向前进一步
+    game->G_TAILCELL = (uint16)snake_next_cell(game->G_TAILCELL, \
+                        (SNAKE_DIR)SNAKE_LINK(game, game->G_COUNT-2), &wrapped);
+#else
+    (void)game;
+#endif
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_get_body_r
+ 功能描述  : 从蛇头到蛇尾依次取出每一节所在的格子
+ 输入参数  : const SNAKE_GAME* game
+             int32 max:cells最多能放几节
+ 输出参数  : uint16* cells:格子编号，编号为y*(SnakeMaxX/SnakePtSize)+x
+ 返 回 值  : 取出的节数
+ 函数说明  : 用于显示和保存游戏，两种蛇身存法都是顺序访问，每节O(1)
+*****************************************************************************/
+int32 snake_get_body_r(const SNAKE_GAME* game, uint16* cells, int32 max)
+{
+    int32 i = 0, n = 0;
+#ifdef SNAKE_PACKED_BODY
+    int32 wrapped = 0;
+#endif
     
-    gettimeofday(&tpstart,RTN_NULL);
-    sseed = (uint32)tpstart.tv_usec;
+    if(cells == RTN_NULL)
+        return 0;
     
-    srand(sseed);
-    s_point->PT_LOCX = rand() % SnakeStepX;
-    s_point->PT_LOCY = rand() % SnakeStepY;
+    if(max > game->G_COUNT)
+        max = game->G_COUNT;
     
-    return s_point;
+    n = snake_body_head(game);
+    for(i=0; i<max; i++)
+    {
+#ifdef SNAKE_PACKED_BODY
+        if(i > 0)
+            n = snake_next_cell(n, SNAKE_BACK[SNAKE_LINK(game, i-1)], &wrapped);
+#else
+        n = SNAKE_AT(game, i);
+#endif
+        cells[i] = (uint16)n;
+    }
+    
+    return max;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_create_food
- 功能描述  : 产生一个点，点的位置是随机的，并且该位置未被占用
- 输入参数  : SNAKE* food:要生成的点
-             SNAKE_PROPY spropy:指定要产生的点的属性(食物?蛇头?蛇身?) 
+ 函 数 名  : snake_rand_seed
+ 功能描述  : 给随机数发生器播种
+ 输入参数  : SNAKE_RAND* rnd
+             uint64 seed:种子
+             uint64 stream:序列号
  输出参数  : 无
  返 回 值  : 
- 函数说明  : 
+ 函数说明  : 不同的序列号得到互不相关的序列
 *****************************************************************************/
-void* snake_create_food(SNAKE* food, SNAKE_PROPY spropy)
+static void snake_rand_seed(SNAKE_RAND* rnd, uint64 seed, uint64 stream)
 {
-    SNAKE_POINT foodxy;
+    rnd->R_STATE = 0;
+    rnd->R_INC = (stream << 1) | 1;
+    rnd->R_STATE = rnd->R_STATE * SnakeRandMult + rnd->R_INC;
+    rnd->R_STATE += seed;
+    rnd->R_STATE = rnd->R_STATE * SnakeRandMult + rnd->R_INC;
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_rand_next
+ 功能描述  : 产生下一个32位随机数
+ 输入参数  : SNAKE_RAND* rnd
+ 输出参数  : 无
+ 返 回 值  : 随机数
+ 函数说明  : PCG32 (XSH RR)
+*****************************************************************************/
+static uint32 snake_rand_next(SNAKE_RAND* rnd)
+{
+    uint64 old = rnd->R_STATE;
+    uint32 xorshifted = 0, rot = 0;
     
-    int32 n = 1;
+    rnd->R_STATE = old * SnakeRandMult + rnd->R_INC;
+    xorshifted = (uint32)(((old >> 18) ^ old) >> 27);
+    rot = (uint32)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_rand_bounded
+ 功能描述  : 产生[0, bound)内均匀分布的随机数
+ 输入参数  : SNAKE_RAND* rnd
+             uint32 bound
+ 输出参数  : 无
+ 返 回 值  : 随机数
+ 函数说明  : 丢弃会造成取模偏差的那一小段
+*****************************************************************************/
+static uint32 snake_rand_bounded(SNAKE_RAND* rnd, uint32 bound)
+{
+    uint32 threshold = (-bound) % bound, r = 0;
     
-    if(food == RTN_NULL)
-        return RTN_NULL;
+    do
+    {
+        r = snake_rand_next(rnd);
+    } while(r < threshold);
     
-    while(n++)//寻找可以放置食物的随机点
+    return r % bound;
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_rand_advance_r
+ 功能描述  : 让游戏的随机数发生器向前跳过delta个数
+ 输入参数  : SNAKE_GAME* game
+             uint64 delta
+ 输出参数  : 无
+ 返 回 值  : 无
+ 函数说明  : 只需O(log delta)步，可以把同一个序列切成互不重叠的几段
+*****************************************************************************/
+void snake_rand_advance_r(SNAKE_GAME* game, uint64 delta)
+{
+    uint64 cur_mult = SnakeRandMult, cur_plus = game->G_RAND.R_INC;
+    uint64 acc_mult = 1, acc_plus = 0;
+    
+    while(delta > 0)
     {
-        snake_get_randxy(&foodxy);//生成一个随机点
-        if(!snake_get_point(&foodxy))
+        if(delta & 1)
         {
-            break;//食物不能在蛇身或者围墙上
-        }
-        if(n > SnakeStepX*SnakeStepY)
-        {
-            n = 0;
-            return RTN_NULL;//尝试完所有的点之后次任然不成功则退出
+            acc_mult *= cur_mult;
+            acc_plus = acc_plus * cur_mult + cur_plus;
         }
+        cur_plus = (cur_mult + 1) * cur_plus;
+        cur_mult *= cur_mult;
+        delta >>= 1;
     }
+    game->G_RAND.R_STATE = acc_mult * game->G_RAND.R_STATE + acc_plus;
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_get_randcell
+ 功能描述  : 随机取一个空白格子
+ 输入参数  : SNAKE_GAME* game
+ 输出参数  : 无
+ 返 回 值  : 格子编号，没有空白格子返回RTN_ERR
+ 函数说明  : 从空白集合里均匀地取一个，不需要反复尝试，只剩一格时也一定能取到
+*****************************************************************************/
+static int32 snake_get_randcell(SNAKE_GAME* game)
+{
+    if(game->G_FREECNT <= 0)
+        return RTN_ERR;
+    
+    return game->G_FREE[snake_rand_bounded(&game->G_RAND, (uint32)game->G_FREECNT)];
+}
+
+/*****************************************************************************
+ 函 数 名  : snake_create_food
+ 功能描述  : 产生一个点，点的位置是随机的，并且该位置未被占用
+ 输入参数  : SNAKE_GAME* game
+             SNAKE_PROPY spropy:指定要产生的点的属性(食物?蛇头?蛇身?)
+ 输出参数  : 无
+ 返 回 值  : 成功返回格子编号，棋盘上没有空白格子时返回RTN_ERR
+ 函数说明  : 
+*****************************************************************************/
+static int32 snake_create_food(SNAKE_GAME* game, SNAKE_PROPY spropy)
+{
+    int32 n = snake_get_randcell(game);
     
-    foodxy.PT_COLOR = COL_WHITE;
-    food->S_POINT.PT_LOCX = foodxy.PT_LOCX;
-    food->S_POINT.PT_LOCY = foodxy.PT_LOCY;
-    food->S_POINT.PT_COLOR = foodxy.PT_COLOR;
-    food->S_PROPERTY = spropy;
+    if(n == RTN_ERR)
+        return RTN_ERR;//食物不能在蛇身或者围墙上，没有空白格子了
     
-    snake_draw_point(&foodxy);
- 
-    return food;
+    snake_set_cell(game, n, spropy);
+    
+    return n;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_game_init
+ 函 数 名  : snake_game_init_r
  功能描述  : 贪吃蛇游戏初始化
- 输入参数  : int32 scnt:初始的蛇身长度
+ 输入参数  : SNAKE_GAME* game
+             int32 scnt:初始的蛇身长度
              SNAKE_DIR sdir:初始的蛇头方向
              int32 sstep:得分速度
              int32 speed:速度
+             uint64 seed:随机数种子
+             uint64 stream:随机数序列号
  输出参数  : 无
  返 回 值  : 
- 函数说明  : 
+ 函数说明  : 随机数来自游戏自己的PCG32发生器，相同的seed和stream得到相同的
+             游戏；stream不同的序列互不相关，可以给并行的模拟各用一个
 *****************************************************************************/
-int32 snake_game_init(int32 scnt, SNAKE_DIR sdir, \
-                        int32 sstep, int32 speed)
+int32 snake_game_init_r(SNAKE_GAME* game, int32 scnt, SNAKE_DIR sdir, \
+                        int32 sstep, int32 speed, \
+                        uint64 seed, uint64 stream)
 {
-    int32 dx = 0, dy = 0, i = 0;
-    SNAKE_POINT snake_head;
+    int32 i = 0, n = 0, wrapped = 0;
     
-    if((scnt <= 0) || (scnt >= SnakeMaxLen) || (sstep < 0) || (speed < 0))
+    if((game == RTN_NULL) || (scnt <= 0) || (scnt >= SnakeMaxLen) || \
+       (sstep < 0) || (speed < 0))
         return RTN_ERR;
     
-    SnakeLife = LF_LIVE;//游戏进程
-    SnakeCount = scnt;//蛇身长度
-    SnakeDir = sdir;//蛇头移动方向
-    SCORE_STEP = sstep;//步进单位
-    SnakeSpeed = speed;//速度或等级
+    game->G_LIFE = LF_LIVE;//游戏进程
+    game->G_SCORE = 0;//得分清零，可以重新开局
+    game->G_COUNT = scnt;//蛇身长度
+    game->G_DIR = sdir;//蛇头移动方向
+    game->G_SCSTEP = sstep;//步进单位
+    game->G_SPEED = speed;//速度或等级
+    
+    memset(game->G_OCC, 0, sizeof(game->G_OCC));
+    game->G_FOOD = SnakeNoFood;
+    game->G_CHANGECNT = 0;
+    for(i=0; i<SnakeCells; i++)
+    {//一开始所有格子都是空白
+        game->G_FREE[i] = i;
+        game->G_FREEPOS[i] = i;
+    }
+    game->G_FREECNT = SnakeCells;
     
-    memset(GAME_SNAKE, 0, sizeof(GAME_SNAKE));
+    snake_rand_seed(&game->G_RAND, seed, stream);
     
     //随机产生一个蛇头
-    if(snake_create_food(&(GAME_SNAKE[0]), PR_HEAD) == RTN_NULL)
+    if((n = snake_create_food(game, PR_HEAD)) == RTN_ERR)
         return RTN_ERR;//生成蛇头失败
     
-    switch(sdir)
+    if((sdir < DR_UP) || (sdir > DR_RIGHT))
+        sdir = DR_RIGHT;
+    
+    //绘制蛇身，朝蛇头的反方向延伸，超出棋盘的部分从另一边接上
+    for(i=1; i< scnt; i++)
     {
-        case DR_UP://上
-            {dx = 0; dy = 1; break;}
-        case DR_DOWN://下
-            {dx = 0; dy = -1; break;}
-        case DR_LEFT://左
-            {dx = 1; dy = 0; break;}
-        default://右
-            {dx = -1; dy = 0; break;}
+        n = snake_next_cell(n, SNAKE_BACK[sdir], &wrapped);
+        if(SNAKE_OCCUPIED(game, n))
+            return RTN_ERR;//蛇身太长，首尾相接了
+        snake_set_cell(game, n, PR_BODY);
     }
     
-    //绘制蛇身
+    //从蛇尾开始一节一节地放进蛇身
+    snake_body_reset(game, n);
     for(i=1; i< scnt; i++)
     {
-        GAME_SNAKE[i].S_POINT.PT_LOCX = \
-            GAME_SNAKE[i-1].S_POINT.PT_LOCX + dx;
-        GAME_SNAKE[i].S_POINT.PT_LOCY = \
-            GAME_SNAKE[i-1].S_POINT.PT_LOCY + dy;
-        GAME_SNAKE[i].S_POINT.PT_COLOR = COL_WHITE;
-        GAME_SNAKE[i].S_PROPERTY = PR_BODY;
-        snake_draw_point(&(GAME_SNAKE[i].S_POINT));
+        n = snake_next_cell(n, sdir, &wrapped);
+        snake_body_push(game, n, sdir);
     }
-
+    
     //产生一个食物
-    if(snake_create_food(&SNAKE_FOOD, PR_FOOD) == RTN_NULL)
+    if(snake_create_food(game, PR_FOOD) == RTN_ERR)
         return RTN_ERR;
-
+    
+    snake_draw_changes(game);
+    
     return RTN_OK;
 }
 
 /*****************************************************************************
  函 数 名  : snake_move_step
  功能描述  : 控制蛇向前移动一步，并处理移动过程中需要处理的事件
- 输入参数  : SNAKE_DIR Dir  
+ 输入参数  : SNAKE_GAME* game
+             SNAKE_DIR Dir
  输出参数  : 无
  返 回 值  : 返回当前的生命状态
  函数说明  : 
 *****************************************************************************/
-SNAKE_LIFE snake_move_step(SNAKE_DIR Dir)
+static SNAKE_LIFE snake_move_step(SNAKE_GAME* game, SNAKE_DIR Dir)
 {
-    int32 dx = 0,dy = 0;
-    uint32 n = 0, i = 0;
-    SNAKE_POINT s_tail;
+    int32 head = 0, tail = 0, next = 0, wrapped = 0, eat = 0;
     
-    //判断移动方向
-    if(Dir == DR_UP)//上
-        {dx = 0; dy = -1;}
-    else if(Dir == DR_DOWN)//下
-        {dx = 0; dy = 1;}
-    else if(Dir == DR_LEFT)//左
-        {dx = -1; dy = 0;}
-    else//右
-        {dx = 1; dy = 0;}
+    if(game->G_LIFE != LF_LIVE)
+        return game->G_LIFE;//游戏已经结束，蛇不再移动
     
-    //更新蛇身坐标
-    for(n=SnakeCount-1; n>0; n--)
-    {
-        memcpy(&(GAME_SNAKE[n].S_POINT), &(GAME_SNAKE[n-1].S_POINT), \
-            sizeof(SNAKE_POINT));
+    if((Dir < DR_UP) || (Dir > DR_RIGHT))
+        Dir = DR_RIGHT;
+    
+    //新的蛇头格子，越界处理要先于碰撞检测，越界之后的格子才是蛇头真正到达的格子
+    head = snake_body_head(game);
+    next = snake_next_cell(head, Dir, &wrapped);
+    if(wrapped && !game->G_CROSSWALL)
+    {//不允许越界
+        snake_game_over(game, LF_DIE);//碰到边界则死亡
+        return game->G_LIFE;
     }
-    //更新蛇头坐标
-    GAME_SNAKE[0].S_POINT.PT_LOCX += dx;
-    GAME_SNAKE[0].S_POINT.PT_LOCY += dy;
     
     //判断蛇的状态:吃到食物?咬到自己?撞到墙?
-    if(snake_get_point(&(GAME_SNAKE[0].S_POINT)))
-    {
-        //if(memcmp(&(GAME_SNAKE[n].S_POINT), &(SNAKE_FOOD.S_POINT), \
-        //        sizeof(SNAKE_POINT) == 0)//用内存比较方式判断坐标是否相等
-        if((GAME_SNAKE[0].S_POINT.PT_LOCX == SNAKE_FOOD.S_POINT.PT_LOCX) || \
-           (GAME_SNAKE[0].S_POINT.PT_LOCY == SNAKE_FOOD.S_POINT.PT_LOCY))
-        {//吃到食物
-            if(snake_create_food(&SNAKE_FOOD, PR_FOOD) != RTN_NULL)
-            {//产生食物成功
-                SnakeCount++;//蛇身长度增加
-                if(SnakeCount >= SnakeMaxLen)
-                    SnakeLife = LF_WIN;//达到最大长度则通关
-                SnakeScore++;//分数增加
-                if(SnakeScore % SCORE_STEP == 0)
-                {
-                    if(SnakeSpeed > SCORE_STEP)
-                    SnakeSpeed -= SCORE_STEP;//速度、等级增加
-                }
-            }
-            else//产生食物不成功,说明此时屏幕上几乎没有可用空间了
-            {
-                SnakeLife = LF_WIN;//这种情况认定为通关
-            }
-        }
-        else
-        {
-            SnakeLife = LF_DIE;//咬到自己或撞到墙则死亡
-        }
+    eat = (next == game->G_FOOD);
+    tail = snake_body_tail(game);
+    if(SNAKE_OCCUPIED(game, next) && (next != tail))
+    {//蛇尾这一步会让开，没吃到食物时可以走进蛇尾所在的格子
+        snake_game_over(game, LF_DIE);//咬到自己或撞到墙则死亡
+        return game->G_LIFE;
     }
-
-    //越界处理
-    if(SCROSS_WALL)
-    {//允许越界
-        if(GAME_SNAKE[0].S_POINT.PT_LOCX >= SnakeStepX) 
-            GAME_SNAKE[0].S_POINT.PT_LOCX = 0;
-        if(GAME_SNAKE[0].S_POINT.PT_LOCX < 0) 
-            GAME_SNAKE[0].S_POINT.PT_LOCX = SnakeStepX - 1;
-        if(GAME_SNAKE[0].S_POINT.PT_LOCY >= SnakeStepY) 
-            GAME_SNAKE[0].S_POINT.PT_LOCY = 0;
-        if(GAME_SNAKE[0].S_POINT.PT_LOCY < 0) 
-            GAME_SNAKE[0].S_POINT.PT_LOCY = SnakeStepY - 1;
+    
+    //消除蛇尾的点，吃到食物时蛇尾不动
+    if(!eat)
+    {
+        snake_set_cell(game, tail, PR_NULL);
+        snake_body_pop(game);
+        game->G_COUNT--;
     }
-    else
-    {//不允许越界
-        if((GAME_SNAKE[0].S_POINT.PT_LOCX >= SnakeStepX) || \
-            (GAME_SNAKE[0].S_POINT.PT_LOCX < 0) || \
-            (GAME_SNAKE[0].S_POINT.PT_LOCY >= SnakeStepY) || \
-            (GAME_SNAKE[0].S_POINT.PT_LOCY < 0))
+    
+    //写入新的蛇头，不需要移动其余各节。只有一节且没吃到食物时旧蛇头就是
+    //刚刚消除的蛇尾，不能再把它写回蛇身
+    if(eat || (head != tail))
+        snake_set_cell(game, head, PR_BODY);
+    snake_body_push(game, next, Dir);
+    snake_set_cell(game, next, PR_HEAD);
+    game->G_COUNT++;
+    
+    if(eat)
+    {//吃到食物
+        game->G_SCORE++;//分数增加
+        if(game->G_RENDER->RD_SCORE != RTN_NULL)
+            game->G_RENDER->RD_SCORE(game->G_RENDERARG, game->G_SCORE);
+        if(game->G_SCORE % game->G_SCSTEP == 0)
         {
-            if(SnakeLife == LF_LIVE)
-                SnakeLife = LF_DIE;//碰到边界则死亡
+            if(game->G_SPEED > game->G_SCSTEP)
+            game->G_SPEED -= game->G_SCSTEP;//速度、等级增加
         }
+        if((game->G_COUNT >= SnakeMaxLen) || \
+           (snake_create_food(game, PR_FOOD) == RTN_ERR))
+            snake_game_over(game, LF_WIN);//占满整个棋盘，没有地方放食物则通关
     }
-    #endif
     
-    //更新显示蛇    
-    for(i=0; i< SnakeCount; i++)
-        {snake_draw_point(&(GAME_SNAKE[i].S_POINT));}
+    //只画变化了的格子
+    snake_draw_changes(game);
     
-    //消除蛇尾的点
-    memcpy(&s_tail, &(GAME_SNAKE[SnakeCount-1].S_POINT), \
-            sizeof(SNAKE_POINT));//获取蛇尾点的坐标
-    s_tail.PT_COLOR = COL_BLACK;
-    snake_draw_point(&s_tail);//消除蛇尾的点
-    
-    return SnakeLife;
+    return game->G_LIFE;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_move_control
+ 函 数 名  : snake_move_control_r
  功能描述  : 根据按键值控制蛇移动
- 输入参数  : SNAKE_DIR KEY
+ 输入参数  : SNAKE_GAME* game
+             SNAKE_DIR KEY
  输出参数  : 无
  返 回 值  : 返回玩家当前的生命状态
  函数说明  : 没有单独的游戏状态处理函数，使用者必须在自己的主函数中根据
-             该函数返回的生命状态来处理游戏进度(比如说当SnakeLife为LF_DIE的
+             该函数返回的生命状态来处理游戏进度(比如说当生命状态为LF_DIE的
              时候该做什么事，这些需要有使用本函数的人自己完成)
 *****************************************************************************/
-SNAKE_LIFE snake_move_control(SNAKE_DIR KEY)
+SNAKE_LIFE snake_move_control_r(SNAKE_GAME* game, SNAKE_DIR KEY)
 {
+    SNAKE_DIR dir = game->G_DIR;
+    
     //只有按下上下左右键才有反应
-    if(((KEY == DR_UP)&&(SnakeDir != DR_DOWN)) || \
-       ((KEY == DR_DOWN)&&(SnakeDir != DR_UP)) || \
-       ((KEY == DR_LEFT)&&(SnakeDir != DR_RIGHT)) || \
-       ((KEY == DR_RIGHT)&&(SnakeDir != DR_LEFT)))//不能反向移动
+    if(((KEY == DR_UP)&&(dir != DR_DOWN)) || \
+       ((KEY == DR_DOWN)&&(dir != DR_UP)) || \
+       ((KEY == DR_LEFT)&&(dir != DR_RIGHT)) || \
+       ((KEY == DR_RIGHT)&&(dir != DR_LEFT)))//不能反向移动
     {
-        SnakeDir = KEY;//更新移动方向
+        game->G_DIR = KEY;//更新移动方向
     }
-    return(snake_move_step(SnakeDir));//按照按键方向移动
+    return(snake_move_step(game, game->G_DIR));//按照按键方向移动
 }
 
 /*****************************************************************************
- 函 数 名  : snake_get_score
+ 函 数 名  : snake_get_score_r
  功能描述  : 获取当前游戏得分
- 输入参数  : 无
+ 输入参数  : const SNAKE_GAME* game
  输出参数  : 无
  返 回 值  : 游戏得分
  函数说明  : 
 *****************************************************************************/
-int32 snake_get_score(void)
+int32 snake_get_score_r(const SNAKE_GAME* game)
 {
-    return SnakeScore;
+    return game->G_SCORE;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_get_speed
+ 函 数 名  : snake_get_speed_r
  功能描述  : 获取当前速度
- 输入参数  : 无
+ 输入参数  : const SNAKE_GAME* game
  输出参数  : 无
  返 回 值  : 速度
  函数说明  : 
 *****************************************************************************/
-int32 snake_get_speed(void)
+int32 snake_get_speed_r(const SNAKE_GAME* game)
 {
-    return SnakeSpeed;
+    return game->G_SPEED;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_set_speed
+ 函 数 名  : snake_set_speed_r
  功能描述  : 设置当前速度
- 输入参数  : int32 speed
+ 输入参数  : SNAKE_GAME* game
+             int32 speed
  输出参数  : 无
  返 回 值  : 速度
  函数说明  : 
 *****************************************************************************/
-int32 snake_set_speed(int32 speed)
+int32 snake_set_speed_r(SNAKE_GAME* game, int32 speed)
 {
     if(speed > 0)
-        SnakeSpeed = speed;
+        game->G_SPEED = speed;
     
-    return SnakeSpeed;
+    return game->G_SPEED;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_sub_speed
+ 函 数 名  : snake_sub_speed_r
  功能描述  : 让速度减小
- 输入参数  : 无
+ 输入参数  : SNAKE_GAME* game
  输出参数  : 无
  返 回 值  : 速度
  函数说明  : 
 *****************************************************************************/
-int32 snake_sub_speed(void)
+int32 snake_sub_speed_r(SNAKE_GAME* game)
 {
-    if(SnakeSpeed < 500)
-        SnakeSpeed += SCORE_STEP;
-    return SnakeSpeed;
+    if(game->G_SPEED < 500)
+        game->G_SPEED += game->G_SCSTEP;
+    return game->G_SPEED;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_add_speed
+ 函 数 名  : snake_add_speed_r
  功能描述  : 让速度增大
- 输入参数  : 无
+ 输入参数  : SNAKE_GAME* game
  输出参数  : 无
  返 回 值  : 速度
  函数说明  : 
 *****************************************************************************/
-int32 snake_add_speed(void)
+int32 snake_add_speed_r(SNAKE_GAME* game)
 {
-    if(SnakeSpeed > SCORE_STEP)
-        SnakeSpeed -= SCORE_STEP;
-    return SnakeSpeed;
+    if(game->G_SPEED > game->G_SCSTEP)
+        game->G_SPEED -= game->G_SCSTEP;
+    return game->G_SPEED;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_get_life
+ 函 数 名  : snake_get_life_r
  功能描述  : 获取当前游戏生命值
- 输入参数  : 无
+ 输入参数  : const SNAKE_GAME* game
  输出参数  : 无
  返 回 值  : 当前游戏生命值
  函数说明  : 
 *****************************************************************************/
-SNAKE_LIFE snake_get_life(void)
+SNAKE_LIFE snake_get_life_r(const SNAKE_GAME* game)
 {
-    return SnakeLife;
+    return game->G_LIFE;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_set_scstep
+ 函 数 名  : snake_set_scstep_r
  功能描述  : 设置游戏得分步进
- 输入参数  : int32 scstep
+ 输入参数  : SNAKE_GAME* game
+             int32 scstep
  输出参数  : 无
  返 回 值  : 游戏得分步进
  函数说明  : 
 *****************************************************************************/
-int32 snake_set_scstep(int32 scstep)
+int32 snake_set_scstep_r(SNAKE_GAME* game, int32 scstep)
 {
     if(scstep > 0)
-        SCORE_STEP = scstep;
-
-    return SCORE_STEP;
+        game->G_SCSTEP = scstep;
+    
+    return game->G_SCSTEP;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_get_dir
+ 函 数 名  : snake_get_dir_r
  功能描述  : 获取当前蛇头方向
- 输入参数  : 无
+ 输入参数  : const SNAKE_GAME* game
  输出参数  : 无
  返 回 值  : 当前蛇头方向
  函数说明  : 
 *****************************************************************************/
-SNAKE_DIR snake_get_dir(void)
+SNAKE_DIR snake_get_dir_r(const SNAKE_GAME* game)
 {
-    return SnakeDir;
+    return game->G_DIR;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_set_dir
+ 函 数 名  : snake_set_dir_r
  功能描述  : 设置当前蛇头方向
- 输入参数  : SNAKE_DIR sdir
+ 输入参数  : SNAKE_GAME* game
+             SNAKE_DIR sdir
  输出参数  : 无
  返 回 值  : 当前蛇头方向
  函数说明  : 
 *****************************************************************************/
-SNAKE_DIR snake_set_dir(SNAKE_DIR sdir)
+SNAKE_DIR snake_set_dir_r(SNAKE_GAME* game, SNAKE_DIR sdir)
 {
     if((sdir == DR_UP) || (sdir == DR_DOWN) || \
         (sdir == DR_LEFT) ||(sdir == DR_RIGHT))
-        SnakeDir = sdir;
-    return SnakeDir;
+        game->G_DIR = sdir;
+    return game->G_DIR;
 }
 
 /*****************************************************************************
- 函 数 名  : snake_set_crosswall
+ 函 数 名  : snake_set_crosswall_r
  功能描述  : 设置是否允许越界
- 输入参数  : int32 crosswall
+ 输入参数  : SNAKE_GAME* game
+             int32 crosswall
  输出参数  : 无
  返 回 值  : 无
  函数说明  : 非零表示允许越界
 *****************************************************************************/
+void snake_set_crosswall_r(SNAKE_GAME* game, int32 crosswall)
+{
+    game->G_CROSSWALL = crosswall;
+}
+
+/*----------------------------------------------*
+ * 以下函数作用于默认游戏                       *
+ *----------------------------------------------*/
+int32 snake_game_init(int32 scnt, SNAKE_DIR sdir, \
+                        int32 sstep, int32 speed, \
+                        uint64 seed, uint64 stream)
+{
+    return snake_game_init_r(snake_default(), scnt, sdir, sstep, speed, seed, stream);
+}
+
+SNAKE_LIFE snake_move_control(SNAKE_DIR KEY)
+{
+    return snake_move_control_r(snake_default(), KEY);
+}
+
+int32 snake_get_score(void)
+{
+    return snake_get_score_r(snake_default());
+}
+
+int32 snake_get_speed(void)
+{
+    return snake_get_speed_r(snake_default());
+}
+
+int32 snake_set_speed(int32 speed)
+{
+    return snake_set_speed_r(snake_default(), speed);
+}
+
+int32 snake_sub_speed(void)
+{
+    return snake_sub_speed_r(snake_default());
+}
+
+int32 snake_add_speed(void)
+{
+    return snake_add_speed_r(snake_default());
+}
+
+SNAKE_LIFE snake_get_life(void)
+{
+    return snake_get_life_r(snake_default());
+}
+
+int32 snake_set_scstep(int32 scstep)
+{
+    return snake_set_scstep_r(snake_default(), scstep);
+}
+
+SNAKE_DIR snake_get_dir(void)
+{
+    return snake_get_dir_r(snake_default());
+}
+
+SNAKE_DIR snake_set_dir(SNAKE_DIR sdir)
+{
+    return snake_set_dir_r(snake_default(), sdir);
+}
+
 void snake_set_crosswall(int32 crosswall)
 {
-    SCROSS_WALL = crosswall;
+    snake_set_crosswall_r(snake_default(), crosswall);
+}
+
+void snake_rand_advance(uint64 delta)
+{
+    snake_rand_advance_r(snake_default(), delta);
+}
+
+int32 snake_get_body(uint16* cells, int32 max)
+{
+    return snake_get_body_r(snake_default(), cells, max);
+}
+
+void snake_set_renderer(const SNAKE_RENDERER* render, void* arg)
+{
+    snake_set_renderer_r(snake_default(), render, arg);
 }
@@ -11,7 +11,8 @@
      : ̰Ϸ
   ӿں   :
               snake_game_init         (int32 scnt, SNAKE_DIR sdir, \
-                                       int32 sstep, int32 speed);
+                                       int32 sstep, int32 speed, \
+                                       uint64 seed, uint64 stream);
               snake_move_control      (SNAKE_DIR KEY);
               snake_get_score         (void);
               snake_get_speed         (void);
@@ -23,6 +24,14 @@
               snake_get_dir           (void);
               snake_set_dir           (SNAKE_DIR sdir);
               snake_set_crosswall     (int32 crosswall);
+              snake_rand_advance      (uint64 delta);
+              snake_get_body          (uint16* cells, int32 max);
+              snake_set_renderer      (const SNAKE_RENDERER* render, \
+                                       void* arg);
+              snake_game_size         (void);
+              snake_game_create       (void* mem, int32 size);
+              snake_game_destroy      (SNAKE_GAME* game);
+              Լ_r׺һΪSNAKE_GAME*İ汾
   ޸ʷ   :
   1.       : 2015922,ڶ
            : Сֵ
@@ -33,7 +42,9 @@
 #define __LCD_SNAKE_H_
 
 #define uint8           unsigned char
+#define uint16          unsigned short
 #define uint32          unsigned int
+#define uint64          unsigned long long
 #define int8   	        char
 #define int32  	        int
 #define RTN_ERR         -1//ش
@@ -43,7 +54,13 @@
 #define SnakeMaxX       128//Ļ
 #define SnakeMaxY       64//Ļ
 #define SnakePtSize     4//Сλ:أΪ
-#define SnakeMaxLen     256//󳤶
+//SNAKE_PACKED_BODYʱÿֻռ2λ2ֽڵĸӱšֻ
+//Сˣհ׸Ӽ(G_FREEG_FREEPOS)ÿҪ4ֽڣһϷ
+//ڴÿԼ6ֽڽԼ4.5ֽڣΪߺܳʡøࡣӱ
+//uint1665535make testִ淨һβȽϽ
+//#define SNAKE_PACKED_BODY
+#define SnakeMaxLen     ((SnakeMaxX / SnakePtSize) * \
+                         (SnakeMaxY / SnakePtSize))//󳤶ȣռ
 
 //
 typedef enum snake_dir
@@ -62,6 +79,31 @@ typedef enum snake_life
     LF_WIN,             //2ʤ
 } SNAKE_LIFE;
 
+//ӵ
+typedef enum snake_propy
+{
+    PR_FOOD = 0,        //0ʳ
+    PR_HEAD,            //1ͷ
+    PR_BODY,            //2
+    PR_WALL,            //3ǽ
+    PR_NULL             //հ
+} SNAKE_PROPY;
+
+//ʾϷķʽҪĺΪNULLargsnake_set_rendererĲ
+typedef struct snake_renderer
+{
+    void (*RD_CELL)(void* arg, int32 x, int32 y, SNAKE_PROPY spropy);//ӱ仯
+    void (*RD_SCORE)(void* arg, int32 score);//÷ֱ仯
+    void (*RD_OVER)(void* arg, SNAKE_LIFE life);//Ϸ
+} SNAKE_RENDERER;
+
+extern const SNAKE_RENDERER snake_null_renderer;//ʲôʾ
+extern const SNAKE_RENDERER snake_lcd_renderer;//ʾlcd128x64ϣsnake_lcd.c
+
+//һϷֻlcd_snake.cпɼ_rĺһĬϷ
+//_rĺڲgameָϷͬϷڲͬ߳ͬʱ
+typedef struct snake_game SNAKE_GAME;
+
 //
 
 /*****************************************************************************
@@ -71,12 +113,16 @@ typedef enum snake_life
              SNAKE_DIR sdir:ʼͷ
              int32 sstep:÷ٶ
              int32 speed:ٶ
+             uint64 seed:
+             uint64 stream:к
    : 
    ֵ  : 
- ˵  : 
+ ˵  : ϷԼPCG32ͬseedstreamõͬ
+             ϷstreamͬлأԸеģһ
 *****************************************************************************/
 extern int32        snake_game_init         (int32 scnt, SNAKE_DIR sdir, \
-                                            int32 sstep, int32 speed);
+                                            int32 sstep, int32 speed, \
+                                            uint64 seed, uint64 stream);
                                             
 /*****************************************************************************
      : snake_move_control
@@ -192,4 +238,101 @@ extern SNAKE_DIR    snake_set_dir           (SNAKE_DIR sdir);
  ˵  : ʾԽ
 *****************************************************************************/
 extern void         snake_set_crosswall     (int32 crosswall);
+
+/*****************************************************************************
+     : snake_rand_advance
+   : Ϸǰdelta
+   : uint64 delta
+   : 
+   ֵ  : 
+ ˵  : ֻO(log delta)԰ͬһгɻصļ
+*****************************************************************************/
+extern void         snake_rand_advance      (uint64 delta);
+
+/*****************************************************************************
+     : snake_get_body
+   : ͷβȡÿһڵĸ
+   : int32 max:cellsܷż
+   : uint16* cells:ӱţΪy*(SnakeMaxX/SnakePtSize)+x
+   ֵ  : ȡĽ
+ ˵  : ʾͱϷ淨˳ʣÿO(1)
+*****************************************************************************/
+extern int32        snake_get_body          (uint16* cells, int32 max);
+
+/*****************************************************************************
+     : snake_set_renderer
+   : ʾϷķʽ
+   : const SNAKE_RENDERER* render:ΪNULLʱʲôʾ
+             void* arg:ԭrenderĸ
+   : 
+   ֵ  : 
+ ˵  : ϷκʾӡϷͨrender֪ͨ
+*****************************************************************************/
+extern void         snake_set_renderer      (const SNAKE_RENDERER* render, \
+                                            void* arg);
+
+/*****************************************************************************
+     : snake_game_size
+   : һϷҪڴС
+   : 
+   : 
+   ֵ  : ֽ
+ ˵  : ڸsnake_game_create׼ڴ
+*****************************************************************************/
+extern int32        snake_game_size         (void);
+
+/*****************************************************************************
+     : snake_game_create
+   : ½һϷ
+   : void* mem:Ϸڴ棬ΪNULLʱɱ
+             int32 size:memֽ
+   : 
+   ֵ  : ɹϷmemûж߷ʧܷRTN_NULL
+ ˵  : memҪsnake_game_size()ֽڣҰ8ֽڶ(malloc
+             ڴ涼)ԴڴһθܶϷڴ档
+             Ϸsnake_game_init_rʼ
+*****************************************************************************/
+extern SNAKE_GAME*  snake_game_create       (void* mem, int32 size);
+
+/*****************************************************************************
+     : snake_game_destroy
+   : һϷ
+   : SNAKE_GAME* game
+   : 
+   ֵ  : 
+ ˵  : ֻͷsnake_game_createڴ棬ṩڴɵ
+             Լ
+*****************************************************************************/
+extern void         snake_game_destroy      (SNAKE_GAME* game);
+
+/*****************************************************************************
+     : snake_*_r
+   : ָϷİ汾
+   : SNAKE_GAME* game:snake_game_createõϷΪNULL
+             ͬ_rĺ
+   : ͬ_rĺ
+   ֵ  : ͬ_rĺ
+ ˵  : һϷͬһʱֻһ߳ʹ
+*****************************************************************************/
+extern int32        snake_game_init_r       (SNAKE_GAME* game, \
+                                            int32 scnt, SNAKE_DIR sdir, \
+                                            int32 sstep, int32 speed, \
+                                            uint64 seed, uint64 stream);
+extern SNAKE_LIFE   snake_move_control_r    (SNAKE_GAME* game, SNAKE_DIR KEY);
+extern int32        snake_get_score_r       (const SNAKE_GAME* game);
+extern int32        snake_get_speed_r       (const SNAKE_GAME* game);
+extern int32        snake_set_speed_r       (SNAKE_GAME* game, int32 speed);
+extern int32        snake_add_speed_r       (SNAKE_GAME* game);
+extern int32        snake_sub_speed_r       (SNAKE_GAME* game);
+extern SNAKE_LIFE   snake_get_life_r        (const SNAKE_GAME* game);
+extern int32        snake_set_scstep_r      (SNAKE_GAME* game, int32 scstep);
+extern SNAKE_DIR    snake_get_dir_r         (const SNAKE_GAME* game);
+extern SNAKE_DIR    snake_set_dir_r         (SNAKE_GAME* game, SNAKE_DIR sdir);
+extern void         snake_set_crosswall_r   (SNAKE_GAME* game, int32 crosswall);
+extern void         snake_rand_advance_r    (SNAKE_GAME* game, uint64 delta);
+extern int32        snake_get_body_r        (const SNAKE_GAME* game, \
+                                            uint16* cells, int32 max);
+extern void         snake_set_renderer_r    (SNAKE_GAME* game, \
+                                            const SNAKE_RENDERER* render, \
+                                            void* arg);
 #endif
\ No newline at end of file
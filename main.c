@@ -27,12 +27,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <wiringPi.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <termios.h>
+#include <time.h>
 #include <pthread.h>
 #include "lcd128x64.h"
 #include "lcd_snake.h"
@@ -48,6 +48,9 @@ void set_keypress (void)
     new_settings = OLD_SETTING;
     /* Disable canonical mode, and set buffer size to 1 byte */
     new_settings.c_lflag &= (~ICANON);
+#ifdef LCD_TERMINAL
+    new_settings.c_lflag &= (~ECHO);//ԣնϵʾ
+#endif
     new_settings.c_cc[VTIME] = 0;
     new_settings.c_cc[VMIN] = 1;
     tcsetattr (0, TCSANOW, &new_settings);
@@ -66,7 +69,7 @@ void* game_snake(void)
     while(1)
     {
         snake_move_control(KEY_DIR);
-        lcd128x64update();
+        lcd128x64flush();//ֻͱ仯˵ļֽ
         usleep(1000*snake_get_speed());
     }
 }
@@ -75,7 +78,12 @@ int main(void)
 {
     pthread_t snake_id;
     int32 ret = 0, ch = 0;
+    char status[128];
     
+#ifdef LCD_TERMINAL
+    lcd128x64termSetup();//նʾ
+    lcd128x64termStatus("WSAD/wsad: move | 1/2: speed | Q/q: exit");
+#else
     lcd128x64setup();
     
     system("clear");//̨ʾ
@@ -83,6 +91,7 @@ int main(void)
     printf("Press \"WSAD\" or \"wsad\" to move Snake!\r\n");
     printf("Press \'1\' to add Speed and \'2\' to sub Speed!\r\n");
     printf("Press \'Q\' or \'q\' or \'ESC\' to Exit Game!\r\n\r\n");
+#endif
     lcd128x64puts(0, 0, "Welcome to Snake Game!"
                         "\r\nby whjwnavy@163.com", 0, 1);
     lcd128x64update();//ʾ
@@ -90,7 +99,9 @@ int main(void)
     lcd128x64clear(0);//Ļʾ
     //system("clear");//̨ʾ
     
-    if(snake_game_init(3, DR_RIGHT, 10, 100) == RTN_ERR)//̰߳ʼ
+    snake_set_renderer(&snake_lcd_renderer, NULL);//ϷҺ
+    if(snake_game_init(3, DR_RIGHT, 10, 100, \
+                       (uint64)time(NULL), 0) == RTN_ERR)//̰߳ʼÿòͬ
         return 0;
     lcd128x64update();//ʾ
     
@@ -162,9 +173,14 @@ int main(void)
             default:
                 break;
         }
-        printf("\rSpeed=%3d | Life=%3d | Score=%3d | Dir=%3d | "
+        snprintf(status, sizeof(status), "Speed=%3d | Life=%3d | Score=%3d | Dir=%3d | "
                 "INPUT KEY=%3c", snake_get_speed(), snake_get_life(), \
             snake_get_score(), snake_get_dir(), ch);
+#ifdef LCD_TERMINAL
+        lcd128x64termStatus(status);//һ֡ʾĻ·
+#else
+        printf("\r%s", status);
+#endif
     }
     reset_keypress();
     return 0;
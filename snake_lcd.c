@@ -0,0 +1,50 @@
+/******************************************************************************
+
+                            胡椒小兄弟                          
+
+ ******************************************************************************
+  文 件 名   : snake_lcd.c
+  版 本 号   : rev01_20150921
+  作    者   : 胡椒小兄弟
+  生成日期   : 2015年9月21日,星期一
+  最近修改   :
+  功能描述   : 把贪吃蛇游戏显示在lcd128x64上
+  接口函数   :
+              snake_lcd_renderer
+  修改历史   :
+
+******************************************************************************/
+
+/*----------------------------------------------*
+ * 包含头文件                                   *
+ *----------------------------------------------*/
+#include <stdio.h>
+#include "lcd128x64.h"
+#include "lcd_snake.h"
+
+/*----------------------------------------------*
+ * 宏定义                                       *
+ *----------------------------------------------*/
+#define SnakeDrawCell   LCD_CELL_FN(SnakePtSize)//按蛇身点大小在编译时选定的画格子函数
+
+/*****************************************************************************
+ 函 数 名  : snake_lcd_cell
+ 功能描述  : 使用缩放过后的DPI绘制一个格子
+ 输入参数  : void* arg:不用
+             int32 x, int32 y:格子坐标
+             SNAKE_PROPY spropy:格子的属性，空白不显示，其余都显示
+ 输出参数  : 无
+ 返 回 值  : 
+ 函数说明  : SnakePtSize是编译时常数，格子由对应大小的lcd128x64cellN直接写进
+             显存，只需一个掩码和几次存储，不用再每格调用通用的矩形函数。
+             SnakePtSize只能是1、2、4或8
+*****************************************************************************/
+static void snake_lcd_cell(void* arg, int32 x, int32 y, SNAKE_PROPY spropy)
+{
+    (void)arg;
+    
+    SnakeDrawCell(x, y, (spropy != PR_NULL));
+}
+
+//得分和游戏结束由主函数显示在状态栏
+const SNAKE_RENDERER snake_lcd_renderer = {snake_lcd_cell, RTN_NULL, RTN_NULL};
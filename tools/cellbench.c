@@ -0,0 +1,147 @@
+/*
+ * cellbench.c:
+ *	Time drawing square cells into the framebuffer, for each cell size
+ *	the game can use, with the generic filled rectangle, the batched
+ *	lcd128x64cells and the lcd128x64cellN specialised for the size.
+ *	Nothing is sent to a panel.
+ *
+ *	Usage: cellbench [-n cells] [-b batch]
+ *
+ *	-n cells      Cells drawn per size and method, default 4000000
+ *	-b batch      Cells per lcd128x64cells call, default 16; a step of
+ *	              the game changes three or four cells
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "lcd128x64.h"
+
+#define	BATCH_MAX   64
+
+static int32 batchSize = 16 ;
+
+static const int32 sizes [4] = { 1, 2, 4, 8 } ;
+static void (*const cellFns [4]) (int32 cx, int32 cy, int32 colour) =
+{
+  LCD_CELL_FN(1), LCD_CELL_FN(2), LCD_CELL_FN(4), LCD_CELL_FN(8)
+} ;
+
+
+static double now (void)
+{
+  struct timespec t ;
+
+  clock_gettime (CLOCK_MONOTONIC, &t) ;
+  return t.tv_sec + t.tv_nsec / 1e9 ;
+}
+
+
+/*
+ * run:
+ *	Draw n cells of size s by method m, sweeping the screen and
+ *	flipping the colour on each sweep, and return the cells a second.
+ *********************************************************************************
+ */
+static double run (int m, int k, long n)
+{
+  lcd128x64cell batch [BATCH_MAX] ;
+  int32 s = sizes [k], w = LCD_WIDTH / s, h = LCD_HEIGHT * 8 / s ;
+  int32 cx = 0, cy = 0, colour = 1, x0, y0, b = 0 ;
+  double t0 = now () ;
+  long i ;
+
+  for (i = 0 ; i < n ; ++i)
+  {
+    switch (m)
+    {
+      case 0:
+        x0 = cx * s ; y0 = cy * s ;
+        lcd128x64rectangle (x0, y0, x0 + s - 1, y0 + s - 1, colour, 1) ;
+        break ;
+
+      case 1:
+        batch [b].x = cx ; batch [b].y = cy ;
+        if (++b == batchSize)
+        {
+          lcd128x64cells (batch, b, s, colour) ;
+          b = 0 ;
+        }
+        break ;
+
+      default:
+        cellFns [k] (cx, cy, colour) ;
+        break ;
+    }
+
+    if (++cx == w)
+    {
+      cx = 0 ;
+      if (++cy == h)
+      {
+        cy = 0 ;
+        colour = !colour ;
+      }
+    }
+  }
+  if (b > 0)
+    lcd128x64cells (batch, b, s, colour) ;
+
+  return n / (now () - t0) ;
+}
+
+
+int main (int argc, char *argv [])
+{
+  static const char *names [3] = { "rectangle", "cells", "cellN" } ;
+  long n = 4000000 ;
+  double rate [3] ;
+  int opt, k, m ;
+
+  while ((opt = getopt (argc, argv, "n:b:")) != -1)
+  {
+    if (opt == 'n')
+      n = atol (optarg) ;
+    else if (opt == 'b')
+      batchSize = atoi (optarg) ;
+    else
+    {
+      fprintf (stderr, "Usage: %s [-n cells] [-b batch]\n", argv [0]) ;
+      return 1 ;
+    }
+  }
+
+  if ((batchSize < 1) || (batchSize > BATCH_MAX))
+  {
+    fprintf (stderr, "%s: batch must be 1 to %d\n", argv [0], BATCH_MAX) ;
+    return 1 ;
+  }
+
+  lcd128x64init () ;
+
+  printf ("size  %12s %12s %12s  (cells/s)\n", names [0], names [1], names [2]) ;
+  for (k = 0 ; k < 4 ; ++k)
+  {
+    for (m = 0 ; m < 3 ; ++m)
+    {
+      lcd128x64clear (0) ;
+      lcd128x64flush () ;
+      rate [m] = run (m, k, n) ;
+      lcd128x64flush () ;
+    }
+    printf ("%4d  %12.0f %12.0f %12.0f  (x%.1f)\n", sizes [k],
+      rate [0], rate [1], rate [2], rate [2] / rate [0]) ;
+  }
+
+  return 0 ;
+}
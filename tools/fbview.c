@@ -0,0 +1,149 @@
+/*
+ * fbview.c:
+ *	Show the panel published by lcd128x64shareStart, in the terminal
+ *	or as a sequence of PBM files. It follows the span ring, so it
+ *	sees every frame unless it falls more than a ring behind.
+ *
+ *	Usage: fbview [-n name] [-p prefix] [-c count] [-i ms]
+ *
+ *	-n name       Segment name, default /lcd128x64
+ *	-p prefix     Write each new frame to prefix00000.pbm, ... instead
+ *	              of drawing it in the terminal
+ *	-c count      Stop after count frames, default never
+ *	-i ms         Polling interval, default 20
+ *
+ *	Two pixel rows make one line of half blocks, so the terminal needs
+ *	128 columns and 32 lines.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lcd128x64shm.h"
+
+#define PIXEL(p,x,y)  (((p) [((y) / 8) * LCD_WIDTH + (x)] >> ((y) & 7)) & 1)
+
+
+/*
+ * drawTerminal:
+ *	Draw a frame in half blocks from the top left of the terminal.
+ *********************************************************************************
+ */
+static void drawTerminal (const uint8 *panel, uint32 frame, uint32 resyncs)
+{
+  static const char *blocks [4] = { " ", "▀", "▄", "█" } ;
+  int x, y ;
+
+  fputs ("\033[H", stdout) ;
+  for (y = 0 ; y < LCD_HEIGHT * 8 ; y += 2)
+  {
+    for (x = 0 ; x < LCD_WIDTH ; ++x)
+      fputs (blocks [PIXEL (panel, x, y) | (PIXEL (panel, x, y + 1) << 1)], stdout) ;
+    fputc ('\n', stdout) ;
+  }
+  printf ("frame %u, %u resyncs\033[K", frame, resyncs) ;
+  fflush (stdout) ;
+}
+
+
+/*
+ * writePbm:
+ *	Write a frame as a raw PBM, lit pixels black.
+ *********************************************************************************
+ */
+static int writePbm (const char *fileName, const uint8 *panel)
+{
+  FILE *fd ;
+  int x, y, c ;
+
+  if ((fd = fopen (fileName, "wb")) == NULL)
+  {
+    perror (fileName) ;
+    return -1 ;
+  }
+
+  fprintf (fd, "P4\n%d %d\n", LCD_WIDTH, LCD_HEIGHT * 8) ;
+  for (y = 0 ; y < LCD_HEIGHT * 8 ; ++y)
+    for (c = x = 0 ; x < LCD_WIDTH ; ++x)
+    {
+      c = (c << 1) | PIXEL (panel, x, y) ;
+      if ((x & 7) == 7)
+      {
+        fputc (c, fd) ;
+        c = 0 ;
+      }
+    }
+
+  fclose (fd) ;
+  return 0 ;
+}
+
+
+int main (int argc, char *argv [])
+{
+  const char *name = LCD_SHM_NAME, *prefix = NULL ;
+  char fileName [256] ;
+  static lcd128x64sub sub ;
+  const lcd128x64shm *shm ;
+  int opt, count = -1, interval = 20, n = 0 ;
+
+  while ((opt = getopt (argc, argv, "n:p:c:i:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'n': name     = optarg ; break ;
+      case 'p': prefix   = optarg ; break ;
+      case 'c': count    = atoi (optarg) ; break ;
+      case 'i': interval = atoi (optarg) ; break ;
+      default:
+        fprintf (stderr, "Usage: %s [-n name] [-p prefix] [-c count] [-i ms]\n", argv [0]) ;
+        return 1 ;
+    }
+  }
+
+  if ((shm = lcd128x64shareOpen (name)) == NULL)
+  {
+    fprintf (stderr, "%s: no lcd128x64 segment\n", name) ;
+    return 1 ;
+  }
+
+  if (prefix == NULL)
+    fputs ("\033[2J", stdout) ;
+
+  lcd128x64subInit (&sub, shm) ;
+  while ((count < 0) || (n < count))
+  {
+    if ((sub.frame == 0) || (lcd128x64subNext (&sub, NULL, NULL) == 0))
+    {
+      usleep (interval * 1000) ;
+      if (sub.frame == 0)
+        lcd128x64subInit (&sub, shm) ;
+      continue ;
+    }
+
+    if (prefix == NULL)
+      drawTerminal (sub.panel, sub.frame, sub.resyncs) ;
+    else
+    {
+      snprintf (fileName, sizeof (fileName), "%s%05d.pbm", prefix, n) ;
+      if (writePbm (fileName, sub.panel) < 0)
+        return 1 ;
+    }
+    ++n ;
+  }
+
+  if (prefix == NULL)
+    fputc ('\n', stdout) ;
+  lcd128x64shareClose (shm) ;
+  return 0 ;
+}
@@ -0,0 +1,276 @@
+/*
+ * fillbench.c:
+ *	Time lcd128x64floodfill on mazes and other awkward shapes, and
+ *	check every fill against a plain flood of the same image. The
+ *	serpentines turn at every row or column, the combs have a tooth
+ *	every other row or column, the maze is a random perfect maze with
+ *	1 pixel corridors, and the lattice (staggered dots on every other
+ *	row) is the worst case found for the seed stack: it needs over
+ *	three times FILL_STACK seeds at once, where the others need at
+ *	most 64. Nothing is sent to a panel.
+ *
+ *	Usage: fillbench [-n fills]
+ *
+ *	-n fills      Fills timed per shape, default 2000
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "lcd128x64.h"
+
+#define	W           128
+#define	H           64
+
+#define	SHAPES      8
+
+static const char *shapeNames [SHAPES] =
+{
+  "open", "serp-rows", "serp-cols", "comb-rows", "comb-cols", "comb-mid", "maze", "lattice"
+} ;
+
+// Where each fill starts
+static const int32 seedX [SHAPES] = { 0, 0, 0, 0, 0, 63, 0, 0 } ;
+
+static uint8 screen [LCD_SAVE_SIZE (W, H)] ;
+static uint8 want [H][W] ;
+
+
+static double now (void)
+{
+  struct timespec t ;
+
+  clock_gettime (CLOCK_MONOTONIC, &t) ;
+  return t.tv_sec + t.tv_nsec / 1e9 ;
+}
+
+
+/*
+ * drawMaze:
+ *	A random perfect maze of corridors one pixel wide: the cells are
+ *	the even pixels, carved out of a lit screen by a depth-first walk.
+ *********************************************************************************
+ */
+static void drawMaze (void)
+{
+  static const int dx [4] = { 1, -1, 0, 0 } ;
+  static const int dy [4] = { 0, 0, 1, -1 } ;
+  static uint8 seen [H / 2][W / 2] ;
+  static short stackX [W * H / 4], stackY [W * H / 4] ;
+  int sp, x, y, nx, ny, d, n, k, dirs [4] ;
+
+  memset (seen, 0, sizeof (seen)) ;
+  srand (1) ;
+  lcd128x64clear (1) ;
+
+  seen [0][0] = 1 ;
+  lcd128x64point (0, 0, 0) ;
+  stackX [0] = 0 ; stackY [0] = 0 ; sp = 1 ;
+
+  while (sp > 0)
+  {
+    x = stackX [sp - 1] ;
+    y = stackY [sp - 1] ;
+
+    for (n = d = 0 ; d < 4 ; ++d)
+    {
+      nx = x + dx [d] ; ny = y + dy [d] ;
+      if ((nx >= 0) && (nx < W / 2) && (ny >= 0) && (ny < H / 2) && !seen [ny][nx])
+        dirs [n++] = d ;
+    }
+    if (n == 0)
+    {
+      --sp ;
+      continue ;
+    }
+
+    k  = dirs [rand () % n] ;
+    nx = x + dx [k] ; ny = y + dy [k] ;
+    seen [ny][nx] = 1 ;
+    lcd128x64point (2 * x + dx [k], 2 * y + dy [k], 0) ;
+    lcd128x64point (2 * nx, 2 * ny, 0) ;
+    stackX [sp] = (short)nx ; stackY [sp] = (short)ny ; ++sp ;
+  }
+}
+
+
+/*
+ * drawShape:
+ *	Draw shape k: walls lit, the space to fill clear.
+ *********************************************************************************
+ */
+static void drawShape (int k)
+{
+  int32 x, y ;
+
+  lcd128x64clear (0) ;
+
+  switch (k)
+  {
+    case 1:
+      for (y = 1 ; y < H ; y += 2)
+        lcd128x64rectangle ((y & 2) ? 1 : 0, y, (y & 2) ? W - 1 : W - 2, y, 1, 1) ;
+      break ;
+
+    case 2:
+      for (x = 1 ; x < W ; x += 2)
+        lcd128x64rectangle (x, (x & 2) ? 1 : 0, x, (x & 2) ? H - 1 : H - 2, 1, 1) ;
+      break ;
+
+    case 3:
+      for (y = 1 ; y < H ; y += 2)
+        lcd128x64rectangle (1, y, W - 1, y, 1, 1) ;
+      break ;
+
+    case 4:
+      for (x = 1 ; x < W ; x += 2)
+        lcd128x64rectangle (x, 1, x, H - 1, 1, 1) ;
+      break ;
+
+    case 5:
+      for (y = 1 ; y < H ; y += 2)
+      {
+        lcd128x64rectangle (0,  y, 62,    y, 1, 1) ;
+        lcd128x64rectangle (64, y, W - 1, y, 1, 1) ;
+      }
+      break ;
+
+    case 6:
+      drawMaze () ;
+      break ;
+
+    case 7:
+      for (y = 1 ; y < H ; y += 2)
+        for (x = (y & 2) ? 1 : 0 ; x < W ; x += 2)
+          lcd128x64point (x, y, 1) ;
+      break ;
+
+    default:
+      break ;
+  }
+}
+
+
+/*
+ * reference:
+ *	What the fill from x,y should leave: a breadth-first flood of the
+ *	screen as it is now, into want. Returns the pixels it fills.
+ *********************************************************************************
+ */
+static int32 reference (int32 x, int32 y)
+{
+  static short qx [W * H], qy [W * H] ;
+  static const int dx [4] = { 1, -1, 0, 0 } ;
+  static const int dy [4] = { 0, 0, 1, -1 } ;
+  int32 head = 0, tail = 0, nx, ny, d ;
+
+  for (ny = 0 ; ny < H ; ++ny)
+    for (nx = 0 ; nx < W ; ++nx)
+      want [ny][nx] = (uint8)lcd128x64getpoint (nx, ny) ;
+
+  if (want [y][x])
+    return 0 ;
+
+  want [y][x] = 1 ;
+  qx [tail] = (short)x ; qy [tail] = (short)y ; ++tail ;
+
+  while (head < tail)
+  {
+    x = qx [head] ; y = qy [head] ; ++head ;
+    for (d = 0 ; d < 4 ; ++d)
+    {
+      nx = x + dx [d] ; ny = y + dy [d] ;
+      if ((nx >= 0) && (nx < W) && (ny >= 0) && (ny < H) && !want [ny][nx])
+      {
+        want [ny][nx] = 1 ;
+        qx [tail] = (short)nx ; qy [tail] = (short)ny ; ++tail ;
+      }
+    }
+  }
+
+  return tail ;
+}
+
+
+int main (int argc, char *argv [])
+{
+  long fills = 2000, i ;
+  int32 area, x, y, rc ;
+  double t0, tFill, tRestore ;
+  int opt, k ;
+
+  while ((opt = getopt (argc, argv, "n:")) != -1)
+  {
+    if (opt == 'n')
+      fills = atol (optarg) ;
+    else
+    {
+      fprintf (stderr, "Usage: %s [-n fills]\n", argv [0]) ;
+      return 1 ;
+    }
+  }
+
+  if (fills < 1)
+  {
+    fprintf (stderr, "%s: fills must be at least 1\n", argv [0]) ;
+    return 1 ;
+  }
+
+  lcd128x64init () ;
+
+  printf ("%-10s %6s  %9s  (us/fill)\n", "shape", "pixels", "fill") ;
+
+  for (k = 0 ; k < SHAPES ; ++k)
+  {
+    drawShape (k) ;
+    lcd128x64save (0, 0, W, H, screen) ;
+    area = reference (seedX [k], 0) ;
+
+    rc = lcd128x64floodfill (seedX [k], 0, 1) ;
+    for (y = 0 ; y < H ; ++y)
+      for (x = 0 ; x < W ; ++x)
+        if (lcd128x64getpoint (x, y) != want [y][x])
+        {
+          fprintf (stderr, "%s: fill differs at %d,%d\n", shapeNames [k], x, y) ;
+          return 1 ;
+        }
+    if (rc != 0)
+    {
+      fprintf (stderr, "%s: fill returned %d\n", shapeNames [k], rc) ;
+      return 1 ;
+    }
+
+    // Each fill has to start from the unfilled screen; time putting it
+    //	back on its own and take that off
+
+    t0 = now () ;
+    for (i = 0 ; i < fills ; ++i)
+    {
+      lcd128x64restore (0, 0, W, H, screen) ;
+      lcd128x64floodfill (seedX [k], 0, 1) ;
+    }
+    tFill = now () - t0 ;
+
+    t0 = now () ;
+    for (i = 0 ; i < fills ; ++i)
+      lcd128x64restore (0, 0, W, H, screen) ;
+    tRestore = now () - t0 ;
+
+    lcd128x64flush () ;
+
+    printf ("%-10s %6d  %9.2f\n", shapeNames [k], area, (tFill - tRestore) * 1e6 / fills) ;
+  }
+
+  return 0 ;
+}
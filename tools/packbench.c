@@ -0,0 +1,223 @@
+/*
+ * packbench.c:
+ *	Measure packed bitmaps on a few typical screens: how well
+ *	lcd128x64pack compresses them, and how fast lcd128x64putpacked and
+ *	lcd128x64unpack decode them next to drawing the unpacked bitmap
+ *	with lcd128x64blit, in MB/s of unpacked bitmap and microseconds an
+ *	image. Every image is checked to decode back to the original first.
+ *	Nothing is sent to a panel.
+ *
+ *	Usage: packbench [-n reps]
+ *
+ *	-n reps       Decodes timed per image and method, default 20000
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "lcd128x64.h"
+
+#define	MAX_BYTES   (LCD_WIDTH * LCD_HEIGHT)
+
+// The screens, each drawn onto a clear screen and read back from 0,0
+
+#define	SCENES      6
+
+static const char *sceneNames [SCENES] =
+{
+  "blank", "text", "shapes", "dither", "noise", "sprite"
+} ;
+
+static const int32 sceneW [SCENES] = { 128, 128, 128, 128, 128, 45 } ;
+static const int32 sceneH [SCENES] = {  64,  64,  64,  64,  64, 21 } ;
+
+
+static double now (void)
+{
+  struct timespec t ;
+
+  clock_gettime (CLOCK_MONOTONIC, &t) ;
+  return t.tv_sec + t.tv_nsec / 1e9 ;
+}
+
+
+/*
+ * drawScene:
+ *	Draw scene k into the framebuffer.
+ *********************************************************************************
+ */
+static void drawScene (int k)
+{
+  static uint8 gray [64][128] ;
+  int32 x, y ;
+
+  lcd128x64clear (0) ;
+
+  switch (k)
+  {
+    case 1:
+      lcd128x64puts (0,  0, "Score: 1234", 0, 1) ;
+      lcd128x64puts (0, 16, "Level 7  Speed 3", 0, 1) ;
+      lcd128x64puts (0, 32, "Press any key", 0, 1) ;
+      lcd128x64puts (0, 48, "to start", 0, 1) ;
+      break ;
+
+    case 2:
+    case 5:
+      lcd128x64rectangle (0, 0, 127, 63, 1, 0) ;
+      lcd128x64circle    (30, 30, 18, 1, 1) ;
+      lcd128x64ellipse   (90, 40, 30, 14, 1, 0) ;
+      lcd128x64line      (0, 63, 127, 0, 1) ;
+      break ;
+
+    case 3:
+      for (y = 0 ; y < 64 ; ++y)
+        for (x = 0 ; x < 128 ; ++x)
+          gray [y][x] = (uint8)(x * 2 + y / 4) ;
+      lcd128x64putgray (0, 0, 128, 64, &gray [0][0], 128, LCD_DITHER_FLOYD) ;
+      break ;
+
+    case 4:
+      srand (1) ;
+      for (y = 0 ; y < 64 ; ++y)
+        for (x = 0 ; x < 128 ; ++x)
+          lcd128x64point (x, y, rand () & 1) ;
+      break ;
+
+    default:
+      break ;
+  }
+}
+
+
+/*
+ * timeDecode:
+ *	Decode an image reps times by method m, flipping the colour each
+ *	time so every byte changes, and return the microseconds per image.
+ *********************************************************************************
+ */
+static double timeDecode (int m, const lcd128x64packed *img, const lcd128x64bitmap *bmp, uint8 *buf, long reps)
+{
+  double t0 = now () ;
+  long i ;
+
+  for (i = 0 ; i < reps ; ++i)
+  {
+    switch (m)
+    {
+      case 0:  lcd128x64blit (0, 0, bmp, i & 1) ;      break ;
+      case 1:  lcd128x64putpacked (0, 0, img, i & 1) ; break ;
+      default: lcd128x64unpack (img, buf) ;             break ;
+    }
+  }
+
+  return (now () - t0) * 1e6 / reps ;
+}
+
+
+int main (int argc, char *argv [])
+{
+  static uint8 raw [MAX_BYTES], packed [LCD_MAX_PACKED (MAX_BYTES)], buf [MAX_BYTES] ;
+  static uint8 below [LCD_WIDTH] ;
+  lcd128x64packed img ;
+  lcd128x64bitmap bmp ;
+  long reps = 20000 ;
+  int32 len, size, w, h, x ;
+  double us [3] ;
+  int opt, k, m ;
+
+  while ((opt = getopt (argc, argv, "n:")) != -1)
+  {
+    if (opt == 'n')
+      reps = atol (optarg) ;
+    else
+    {
+      fprintf (stderr, "Usage: %s [-n reps]\n", argv [0]) ;
+      return 1 ;
+    }
+  }
+
+  if (reps < 1)
+  {
+    fprintf (stderr, "%s: reps must be at least 1\n", argv [0]) ;
+    return 1 ;
+  }
+
+  lcd128x64init () ;
+
+  printf ("%61s  %29s\n", "MB/s", "us/image") ;
+  printf ("%-7s %7s %6s %7s  %9s %9s %9s  %9s %9s %9s\n",
+    "image", "size", "packed", "ratio", "blit", "putpacked", "unpack", "blit", "putpacked", "unpack") ;
+
+  for (k = 0 ; k < SCENES ; ++k)
+  {
+    w   = sceneW [k] ;
+    h   = sceneH [k] ;
+    len = w * ((h + 7) / 8) ;
+
+    drawScene (k) ;
+    lcd128x64read (0, 0, w, h, raw) ;
+    size = lcd128x64pack (raw, len, packed) ;
+
+    img.width  = w ;
+    img.height = h ;
+    img.size   = size ;
+    img.data   = packed ;
+
+    memset (&bmp, 0, sizeof (bmp)) ;
+    bmp.width    = w ;
+    bmp.height   = h ;
+    bmp.data [0] = raw ;
+
+    // The round trip, and the rows under a bitmap whose height isn't a
+    //	multiple of 8 must be left alone
+
+    if ((lcd128x64unpack (&img, buf) != 0) || (memcmp (buf, raw, len) != 0))
+    {
+      fprintf (stderr, "%s: unpack doesn't match\n", sceneNames [k]) ;
+      return 1 ;
+    }
+
+    lcd128x64clear (1) ;
+    lcd128x64putpacked (0, 0, &img, 1) ;
+    lcd128x64read (0, 0, w, h, buf) ;
+    x = w ;
+    if (h & 7)
+    {
+      lcd128x64read (0, h, w, 1, below) ;
+      for (x = 0 ; (x < w) && (below [x] == 1) ; ++x)
+        ;
+    }
+    if ((memcmp (buf, raw, len) != 0) || (x < w))
+    {
+      fprintf (stderr, "%s: putpacked doesn't match\n", sceneNames [k]) ;
+      return 1 ;
+    }
+
+    for (m = 0 ; m < 3 ; ++m)
+    {
+      lcd128x64clear (0) ;
+      lcd128x64flush () ;
+      us [m] = timeDecode (m, &img, &bmp, buf, reps) ;
+      lcd128x64flush () ;
+    }
+
+    // Bytes a microsecond are MB/s
+
+    printf ("%-7s %3dx%-3d %6d %5.2f:1  %9.1f %9.1f %9.1f  %9.2f %9.2f %9.2f\n", sceneNames [k], w, h,
+      size, (double)len / size, len / us [0], len / us [1], len / us [2], us [0], us [1], us [2]) ;
+  }
+
+  return 0 ;
+}
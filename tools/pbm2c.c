@@ -0,0 +1,306 @@
+/*
+ * pbm2c.c:
+ *	Convert PBM/PGM art into page-major C arrays for lcd128x64blit.
+ *
+ *	Usage: pbm2c [-n name] [-t threshold] [-i] [-s | -z] file.pbm > file.h
+ *
+ *	-n name       Symbol name, default derived from the file name
+ *	-t threshold  Grey level (0..maxval) below which a PGM pixel
+ *	              is lit, default half of maxval
+ *	-i            Invert: light the white pixels instead
+ *	-s            Also emit the 7 pre-shifted variants
+ *	-z            Emit a packed lcd128x64packed for lcd128x64putpacked
+ *	              instead, and report the compression ratio on stderr
+ *
+ *	Dark pixels are lit, in a PGM as in a PBM. The output is a
+ *	header holding a const lcd128x64bitmap (or lcd128x64packed);
+ *	include lcd128x64.h before it.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+#include "lcd128x64.h"
+
+
+/*
+ * readInt:
+ *	Read the next decimal number of a netpbm header, skipping
+ *	whitespace and comments.
+ *********************************************************************************
+ */
+static int readInt (FILE *fd)
+{
+  int c, n = 0 ;
+
+  for (;;)
+  {
+    c = fgetc (fd) ;
+    if (c == '#')
+    {
+      while ((c != '\n') && (c != EOF))
+        c = fgetc (fd) ;
+    }
+    else if (!isspace (c))
+      break ;
+  }
+
+  if (!isdigit (c))
+    return -1 ;
+
+  while (isdigit (c))
+  {
+    n = n * 10 + (c - '0') ;
+    c = fgetc (fd) ;
+  }
+
+  return n ;
+}
+
+
+/*
+ * readBit:
+ *	Read the next pixel of a plain PBM raster, where the digits need
+ *	not be separated.
+ *********************************************************************************
+ */
+static int readBit (FILE *fd)
+{
+  int c ;
+
+  for (;;)
+  {
+    c = fgetc (fd) ;
+    if (c == '#')
+    {
+      while ((c != '\n') && (c != EOF))
+        c = fgetc (fd) ;
+    }
+    else if (!isspace (c))
+      break ;
+  }
+
+  return c == '1' ;
+}
+
+
+/*
+ * loadImage:
+ *	Load a P1, P2, P4 or P5 image into one byte per pixel, 1 for lit:
+ *	a PBM 1 (black), or a PGM grey level below threshold.
+ *********************************************************************************
+ */
+static unsigned char *loadImage (const char *fileName, int *width, int *height, int threshold, int invert)
+{
+  FILE *fd ;
+  unsigned char *img ;
+  int kind, w, h, maxval = 1, x, y, v, c = 0 ;
+
+  if ((fd = fopen (fileName, "rb")) == NULL)
+  {
+    perror (fileName) ;
+    return NULL ;
+  }
+
+  if ((fgetc (fd) != 'P') || ((kind = fgetc (fd) - '0') < 1) || (kind == 3) || (kind > 5))
+  {
+    fprintf (stderr, "%s: not a PBM or PGM file\n", fileName) ;
+    fclose (fd) ;
+    return NULL ;
+  }
+
+  w = readInt (fd) ;
+  h = readInt (fd) ;
+  if ((kind == 2) || (kind == 5))
+    maxval = readInt (fd) ;
+
+  if ((w <= 0) || (h <= 0) || (maxval <= 0) || (maxval > 255))
+  {
+    fprintf (stderr, "%s: unsupported image header\n", fileName) ;
+    fclose (fd) ;
+    return NULL ;
+  }
+
+  if (threshold < 0)
+    threshold = (maxval + 1) / 2 ;
+
+  if ((img = calloc ((size_t)w * h, 1)) == NULL)
+  {
+    fprintf (stderr, "%s: out of memory\n", fileName) ;
+    fclose (fd) ;
+    return NULL ;
+  }
+
+  for (y = 0 ; y < h ; ++y)
+  {
+    for (x = 0 ; x < w ; ++x)
+    {
+      switch (kind)
+      {
+        case 1:	v = readBit (fd) ; break ;
+        case 2:	v = readInt (fd) < threshold ; break ;
+        case 4:
+          if ((x & 7) == 0)
+            c = fgetc (fd) ;
+          v = (c >> (7 - (x & 7))) & 1 ;
+          break ;
+        default:
+          v = fgetc (fd) < threshold ;
+          break ;
+      }
+      img [y * w + x] = (unsigned char)((v > 0) != (invert != 0)) ;
+    }
+  }
+
+  fclose (fd) ;
+  *width  = w ;
+  *height = h ;
+  return img ;
+}
+
+
+/*
+ * buildPlane:
+ *	Lay the image out shifted down by shift rows as page-major bytes:
+ *	every page is one byte per column, bit 0 the top row of the page.
+ *	Returns the number of bytes.
+ *********************************************************************************
+ */
+static int buildPlane (unsigned char *out, const unsigned char *img, int w, int h, int shift)
+{
+  int pages = (h + shift + 7) / 8 ;
+  int page, x, b, row, n = 0 ;
+  unsigned char byte ;
+
+  for (page = 0 ; page < pages ; ++page)
+  {
+    for (x = 0 ; x < w ; ++x)
+    {
+      byte = 0 ;
+      for (b = 0 ; b < 8 ; ++b)
+      {
+        row = page * 8 + b - shift ;
+        if ((row >= 0) && (row < h) && img [row * w + x])
+          byte |= (unsigned char)(1 << b) ;
+      }
+      out [n++] = byte ;
+    }
+  }
+
+  return n ;
+}
+
+
+/*
+ * emitBytes:
+ *	Write a byte array as a C initialiser.
+ *********************************************************************************
+ */
+static void emitBytes (const char *name, const char *suffix, const unsigned char *buf, int len)
+{
+  int i ;
+
+  printf ("static const uint8 %s_%s [] =\n{", name, suffix) ;
+  for (i = 0 ; i < len ; ++i)
+    printf ("%s0x%02X,", (i % 12) ? " " : "\n  ", buf [i]) ;
+  printf ("\n} ;\n\n") ;
+}
+
+
+int main (int argc, char *argv [])
+{
+  char name [64] = "" ;
+  const char *base ;
+  char suffix [16] ;
+  unsigned char *img, *plane, *packed ;
+  int opt, threshold = -1, invert = 0, shifted = 0, compress = 0 ;
+  int w, h, s, i, len, size ;
+
+  while ((opt = getopt (argc, argv, "n:t:isz")) != -1)
+  {
+    switch (opt)
+    {
+      case 'n': snprintf (name, sizeof (name), "%s", optarg) ; break ;
+      case 't': threshold = atoi (optarg) ; break ;
+      case 'i': invert    = 1 ; break ;
+      case 's': shifted   = 1 ; break ;
+      case 'z': compress  = 1 ; break ;
+      default:
+        fprintf (stderr, "Usage: %s [-n name] [-t threshold] [-i] [-s | -z] file.pbm\n", argv [0]) ;
+        return 1 ;
+    }
+  }
+
+  if ((optind != argc - 1) || (shifted && compress))
+  {
+    fprintf (stderr, "Usage: %s [-n name] [-t threshold] [-i] [-s | -z] file.pbm\n", argv [0]) ;
+    return 1 ;
+  }
+
+  if (name [0] == '\0')
+  {
+    base = strrchr (argv [optind], '/') ;
+    base = base ? base + 1 : argv [optind] ;
+    for (i = 0 ; base [i] && (base [i] != '.') && (i < (int)sizeof (name) - 1) ; ++i)
+      name [i] = isalnum ((unsigned char)base [i]) ? base [i] : '_' ;
+    name [i] = '\0' ;
+  }
+
+  if ((img = loadImage (argv [optind], &w, &h, threshold, invert)) == NULL)
+    return 1 ;
+
+  plane  = malloc ((size_t)w * ((h + 7) / 8 + 1)) ;
+  packed = compress ? malloc ((size_t)LCD_MAX_PACKED (w * ((h + 7) / 8))) : NULL ;
+  if ((plane == NULL) || (compress && (packed == NULL)))
+  {
+    fprintf (stderr, "%s: out of memory\n", argv [0]) ;
+    return 1 ;
+  }
+
+  printf ("/*\n * %s:\n *\tGenerated by pbm2c from %s, %dx%d. Do not edit.\n */\n\n", name, argv [optind], w, h) ;
+
+  if (compress)
+  {
+    len    = buildPlane (plane, img, w, h, 0) ;
+    size   = lcd128x64pack (plane, len, packed) ;
+    emitBytes (name, "packed", packed, size) ;
+    printf ("static const lcd128x64packed %s =\n{\n  %d, %d, %d, %s_packed\n} ;\n", name, w, h, size, name) ;
+    fprintf (stderr, "%s: %d -> %d bytes, ratio %.2f:1\n", name, len, size, (double)len / size) ;
+    free (packed) ;
+    free (plane) ;
+    free (img) ;
+    return 0 ;
+  }
+
+  for (s = 0 ; s < (shifted ? 8 : 1) ; ++s)
+  {
+    len = buildPlane (plane, img, w, h, s) ;
+    snprintf (suffix, sizeof (suffix), "data%d", s) ;
+    emitBytes (name, suffix, plane, len) ;
+  }
+
+  printf ("static const lcd128x64bitmap %s =\n{\n  %d, %d,\n  {", name, w, h) ;
+  for (s = 0 ; s < 8 ; ++s)
+  {
+    if ((s == 0) || shifted)
+      printf (" %s_data%d%s", name, s, (s < 7) ? "," : "") ;
+    else
+      printf (" NULL%s", (s < 7) ? "," : "") ;
+  }
+  printf (" }\n} ;\n") ;
+
+  free (plane) ;
+  free (img) ;
+  return 0 ;
+}
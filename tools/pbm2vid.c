@@ -0,0 +1,244 @@
+/*
+ * pbm2vid.c:
+ *	Build a video for lcd128x64playVideo from a sequence of PBM frames.
+ *
+ *	Usage: pbm2vid [-r fps] [-k interval] -o out.lvid frame.pbm ...
+ *
+ *	-r fps        Frame rate, default 30
+ *	-k interval   Frames between keyframes, default 30; 0 for only
+ *	              the first
+ *	-o file       Output file
+ *
+ *	All frames must have the size of the first. A black pixel is a
+ *	lit pixel, as with pbm2c.
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+#include "lcd128x64video.h"
+
+
+/*
+ * readInt:
+ *	Read the next decimal number of a netpbm header, skipping
+ *	whitespace and comments.
+ *********************************************************************************
+ */
+static int readInt (FILE *fd)
+{
+  int c, n = 0 ;
+
+  for (;;)
+  {
+    c = fgetc (fd) ;
+    if (c == '#')
+    {
+      while ((c != '\n') && (c != EOF))
+        c = fgetc (fd) ;
+    }
+    else if (!isspace (c))
+      break ;
+  }
+
+  if (!isdigit (c))
+    return -1 ;
+
+  while (isdigit (c))
+  {
+    n = n * 10 + (c - '0') ;
+    c = fgetc (fd) ;
+  }
+
+  return n ;
+}
+
+
+/*
+ * loadFrame:
+ *	Load a P1 or P4 image as page-major bytes. Returns 0 on success.
+ *********************************************************************************
+ */
+static int loadFrame (const char *fileName, int *width, int *height, uint8 **frame)
+{
+  FILE *fd ;
+  int kind, w, h, x, y, v, c = 0 ;
+
+  if ((fd = fopen (fileName, "rb")) == NULL)
+  {
+    perror (fileName) ;
+    return -1 ;
+  }
+
+  if ((fgetc (fd) != 'P') || (((kind = fgetc (fd)) != '1') && (kind != '4')) ||
+      ((w = readInt (fd)) <= 0) || ((h = readInt (fd)) <= 0) || (w > 0xFFFF) || (h > 0xFFFF))
+  {
+    fprintf (stderr, "%s: not a PBM file\n", fileName) ;
+    fclose (fd) ;
+    return -1 ;
+  }
+
+  if (*frame == NULL)
+  {
+    *width  = w ;
+    *height = h ;
+    *frame  = malloc ((size_t)w * ((h + 7) / 8)) ;
+    if (*frame == NULL)
+    {
+      fprintf (stderr, "%s: out of memory\n", fileName) ;
+      fclose (fd) ;
+      return -1 ;
+    }
+  }
+  else if ((w != *width) || (h != *height))
+  {
+    fprintf (stderr, "%s: frame size differs from the first frame\n", fileName) ;
+    fclose (fd) ;
+    return -1 ;
+  }
+
+  memset (*frame, 0, (size_t)w * ((h + 7) / 8)) ;
+  for (y = 0 ; y < h ; ++y)
+  {
+    for (x = 0 ; x < w ; ++x)
+    {
+      if (kind == '4')
+      {
+        if ((x & 7) == 0)
+          c = fgetc (fd) ;
+        v = (c >> (7 - (x & 7))) & 1 ;
+      }
+      else
+      {
+        while (isspace (c = fgetc (fd)))
+          ;
+        v = (c == '1') ;
+      }
+      if (v)
+        (*frame) [(y / 8) * w + x] |= (uint8)(1 << (y & 7)) ;
+    }
+  }
+
+  fclose (fd) ;
+  return 0 ;
+}
+
+
+/*
+ * put16: put32:
+ *	Write little-endian numbers.
+ *********************************************************************************
+ */
+static void put16 (FILE *fd, uint32 v)
+{
+  fputc (v & 0xFF, fd) ;
+  fputc ((v >> 8) & 0xFF, fd) ;
+}
+
+static void put32 (FILE *fd, uint32 v)
+{
+  put16 (fd, v & 0xFFFF) ;
+  put16 (fd, v >> 16) ;
+}
+
+
+int main (int argc, char *argv [])
+{
+  const char *outName = NULL ;
+  uint8 *frame = NULL, *prev, *delta ;
+  FILE *out ;
+  int opt, fps = 30, interval = 30, w = 0, h = 0, len, size, i, n, key ;
+  long total = 0 ;
+
+  while ((opt = getopt (argc, argv, "r:k:o:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'r': fps      = atoi (optarg) ; break ;
+      case 'k': interval = atoi (optarg) ; break ;
+      case 'o': outName  = optarg ; break ;
+      default:
+        outName = NULL ;
+        optind  = argc ;
+        break ;
+    }
+  }
+
+  if ((outName == NULL) || (optind >= argc) || (fps <= 0) || (interval < 0))
+  {
+    fprintf (stderr, "Usage: %s [-r fps] [-k interval] -o out.lvid frame.pbm ...\n", argv [0]) ;
+    return 1 ;
+  }
+
+  if ((out = fopen (outName, "wb")) == NULL)
+  {
+    perror (outName) ;
+    return 1 ;
+  }
+
+  n = argc - optind ;
+  prev = delta = NULL ;
+
+  fwrite ("LVID", 1, 4, out) ;
+  put16 (out, 0) ;
+  put16 (out, 0) ;
+  put32 (out, (uint32)n) ;
+  put32 (out, 0) ;
+
+  for (i = 0 ; i < n ; ++i)
+  {
+    if (loadFrame (argv [optind + i], &w, &h, &frame) < 0)
+    {
+      fclose (out) ;
+      return 1 ;
+    }
+
+    len = w * ((h + 7) / 8) ;
+    if (prev == NULL)
+    {
+      prev  = malloc ((size_t)len) ;
+      delta = malloc ((size_t)LVID_MAX_DELTA (len)) ;
+      if ((prev == NULL) || (delta == NULL))
+      {
+        fprintf (stderr, "%s: out of memory\n", argv [0]) ;
+        fclose (out) ;
+        return 1 ;
+      }
+    }
+
+    key  = (i == 0) || ((interval > 0) && (i % interval == 0)) ;
+    size = lcd128x64deltaEncode (key ? NULL : prev, frame, len, delta) ;
+    memcpy (prev, frame, (size_t)len) ;
+
+    fputc (key ? LVID_KEY : LVID_DELTA, out) ;
+    fputc (0, out) ; fputc (0, out) ; fputc (0, out) ;
+    put32 (out, (uint32)((long)i * 1000 / fps)) ;
+    put32 (out, (uint32)size) ;
+    fwrite (delta, 1, (size_t)size, out) ;
+    total += size ;
+  }
+
+  fseek (out, 4, SEEK_SET) ;
+  put16 (out, (uint32)w) ;
+  put16 (out, (uint32)h) ;
+  fclose (out) ;
+
+  fprintf (stderr, "%s: %d frames of %dx%d, %ld bytes of deltas, %.1f per frame\n",
+           outName, n, w, h, total, (double)total / n) ;
+
+  free (frame) ;
+  free (prev) ;
+  free (delta) ;
+  return 0 ;
+}
@@ -0,0 +1,185 @@
+/*
+ * rec2pbm.c:
+ *	Export the frames of a recording (or any lcd128x64 video) as a
+ *	numbered sequence of PBM files.
+ *
+ *	Usage: rec2pbm [-p prefix] [-l] file.lvid
+ *
+ *	-p prefix     Output names, default "frame": frame00000.pbm, ...
+ *	-l            Only list the frames and their times
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lcd128x64video.h"
+
+
+/*
+ * get16: get32:
+ *	Little-endian numbers.
+ *********************************************************************************
+ */
+static uint32 get16 (const uint8 *p)
+{
+  return p [0] | (p [1] << 8) ;
+}
+
+static uint32 get32 (const uint8 *p)
+{
+  return p [0] | (p [1] << 8) | (p [2] << 16) | ((uint32)p [3] << 24) ;
+}
+
+
+/*
+ * writePbm:
+ *	Write a page-major frame as a raw PBM, lit pixels black.
+ *********************************************************************************
+ */
+static int writePbm (const char *fileName, const uint8 *frame, int w, int h)
+{
+  FILE *fd ;
+  int x, y, c ;
+
+  if ((fd = fopen (fileName, "wb")) == NULL)
+  {
+    perror (fileName) ;
+    return -1 ;
+  }
+
+  fprintf (fd, "P4\n%d %d\n", w, h) ;
+  for (y = 0 ; y < h ; ++y)
+  {
+    for (c = x = 0 ; x < w ; ++x)
+    {
+      c = (c << 1) | ((frame [(y / 8) * w + x] >> (y & 7)) & 1) ;
+      if ((x & 7) == 7)
+      {
+        fputc (c, fd) ;
+        c = 0 ;
+      }
+    }
+    if (w & 7)
+      fputc (c << (8 - (w & 7)), fd) ;
+  }
+
+  fclose (fd) ;
+  return 0 ;
+}
+
+
+int main (int argc, char *argv [])
+{
+  const char *prefix = "frame" ;
+  char name [256] ;
+  uint8 head [LVID_HEADER], rec [LVID_RECORD] ;
+  uint8 *frame, *delta, *more ;
+  FILE *fd ;
+  int opt, list = 0, w, h, len ;
+  uint32 frames, i, size ;
+
+  while ((opt = getopt (argc, argv, "p:l")) != -1)
+  {
+    switch (opt)
+    {
+      case 'p': prefix = optarg ; break ;
+      case 'l': list   = 1 ; break ;
+      default:
+        fprintf (stderr, "Usage: %s [-p prefix] [-l] file.lvid\n", argv [0]) ;
+        return 1 ;
+    }
+  }
+
+  if (optind != argc - 1)
+  {
+    fprintf (stderr, "Usage: %s [-p prefix] [-l] file.lvid\n", argv [0]) ;
+    return 1 ;
+  }
+
+  if ((fd = fopen (argv [optind], "rb")) == NULL)
+  {
+    perror (argv [optind]) ;
+    return 1 ;
+  }
+
+  if ((fread (head, 1, LVID_HEADER, fd) != LVID_HEADER) || (memcmp (head, "LVID", 4) != 0) ||
+      ((w = (int)get16 (head + 4)) == 0) || ((h = (int)get16 (head + 6)) == 0))
+  {
+    fprintf (stderr, "%s: not a video file\n", argv [optind]) ;
+    fclose (fd) ;
+    return 1 ;
+  }
+
+  frames = get32 (head + 8) ;
+  len    = w * ((h + 7) / 8) ;
+  delta  = NULL ;
+
+  if ((frame = calloc ((size_t)len, 1)) == NULL)
+  {
+    fprintf (stderr, "%s: out of memory\n", argv [0]) ;
+    fclose (fd) ;
+    return 1 ;
+  }
+
+  for (i = 0 ; i < frames ; ++i)
+  {
+    if (fread (rec, 1, LVID_RECORD, fd) != LVID_RECORD)
+      break ;
+    size = get32 (rec + 8) ;
+
+    // No encoder writes more than LVID_MAX_DELTA, so a bigger record is a
+    //	damaged file, not a reason to allocate whatever it claims
+
+    if (size > (uint32)LVID_MAX_DELTA (len))
+    {
+      fprintf (stderr, "%s: frame %u is corrupt\n", argv [optind], i) ;
+      break ;
+    }
+    if ((more = realloc (delta, size ? size : 1)) == NULL)
+    {
+      fprintf (stderr, "%s: out of memory\n", argv [0]) ;
+      break ;
+    }
+    delta = more ;
+    if (fread (delta, 1, size, fd) != size)
+      break ;
+
+    if (rec [0] == LVID_KEY)
+      memset (frame, 0, (size_t)len) ;
+    if (lcd128x64deltaApply (frame, len, delta, (int32)size) < 0)
+    {
+      fprintf (stderr, "%s: frame %u is corrupt\n", argv [optind], i) ;
+      break ;
+    }
+
+    if (list)
+      printf ("%5u %c %8u ms %6u bytes\n", i, rec [0], get32 (rec + 4), size) ;
+    else
+    {
+      snprintf (name, sizeof (name), "%s%05u.pbm", prefix, i) ;
+      if (writePbm (name, frame, w, h) < 0)
+        break ;
+    }
+  }
+
+  fclose (fd) ;
+  free (frame) ;
+  free (delta) ;
+
+  if (i < frames)
+  {
+    fprintf (stderr, "%s: stopped after %u of %u frames\n", argv [optind], i, frames) ;
+    return 1 ;
+  }
+  return 0 ;
+}
@@ -0,0 +1,231 @@
+/*
+ * snake_sim.c:
+ *	Play games of snake with no display, for testing the engine and
+ *	timing it. A simple bot steers each game towards the food, seeing
+ *	the board only through the renderer calls the engine makes.
+ *
+ *	Usage: snake_sim [-n games] [-s seed] [-t steps] [-w] [-v]
+ *
+ *	-n games      Games to play, default 1000
+ *	-s seed       Seed for every game; game i plays on stream i
+ *	-t steps      Give up on a game after this many steps, default 100000
+ *	-w            Walls kill instead of wrapping round
+ *	-v            Print the result of every game
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "lcd_snake.h"
+
+#define	BOARD_W   (SnakeMaxX / SnakePtSize)
+#define	BOARD_H   (SnakeMaxY / SnakePtSize)
+
+// What the bot knows, kept up to date by the renderer
+
+struct simBoard
+{
+  uint8 cell [BOARD_H][BOARD_W] ;
+  int   foodX, foodY ;
+  int   score ;
+  int   over ;
+  uint32 cells ;		// renderer cell calls
+} ;
+
+static struct simBoard board ;
+
+
+/*
+ * simCell: simScore: simOver:
+ *	The renderer.
+ *********************************************************************************
+ */
+static void simCell (void *arg, int32 x, int32 y, SNAKE_PROPY spropy)
+{
+  struct simBoard *b = arg ;
+
+  b->cell [y][x] = (uint8)spropy ;
+  if (spropy == PR_FOOD)
+  {
+    b->foodX = x ;
+    b->foodY = y ;
+  }
+  ++b->cells ;
+}
+
+static void simScore (void *arg, int32 score)
+{
+  ((struct simBoard *)arg)->score = score ;
+}
+
+static void simOver (void *arg, SNAKE_LIFE life)
+{
+  ((struct simBoard *)arg)->over = life ;
+}
+
+static const SNAKE_RENDERER simRenderer = { simCell, simScore, simOver } ;
+
+
+/*
+ * step: distance:
+ *	Where a move from x, y in direction d lands, and how far apart two
+ *	cells are, both allowing for wrapping round when wrap is set.
+ *********************************************************************************
+ */
+static const int dirX [4] = { 0, 0, -1, 1 } ;
+static const int dirY [4] = { -1, 1, 0, 0 } ;
+
+static int step (int *x, int *y, int d, int wrap)
+{
+  *x += dirX [d] ;
+  *y += dirY [d] ;
+
+  if ((*x < 0) || (*x >= BOARD_W) || (*y < 0) || (*y >= BOARD_H))
+  {
+    if (!wrap)
+      return 0 ;
+    *x = (*x + BOARD_W) % BOARD_W ;
+    *y = (*y + BOARD_H) % BOARD_H ;
+  }
+  return 1 ;
+}
+
+static int distance (int x0, int y0, int x1, int y1, int wrap)
+{
+  int dx = abs (x1 - x0), dy = abs (y1 - y0) ;
+
+  if (wrap)
+  {
+    if (BOARD_W - dx < dx) dx = BOARD_W - dx ;
+    if (BOARD_H - dy < dy) dy = BOARD_H - dy ;
+  }
+  return dx + dy ;
+}
+
+
+/*
+ * choose:
+ *	The bot: of the moves that don't hit anything, the one that gets
+ *	closest to the food; if there are none, carry on.
+ *********************************************************************************
+ */
+static SNAKE_DIR choose (int hx, int hy, SNAKE_DIR dir, int wrap)
+{
+  static const SNAKE_DIR back [4] = { DR_DOWN, DR_UP, DR_RIGHT, DR_LEFT } ;
+  int d, x, y, dist, best = -1, bestDist = 1 << 30 ;
+
+  for (d = 0 ; d < 4 ; ++d)
+  {
+    if (d == (int)back [dir])
+      continue ;
+    x = hx ; y = hy ;
+    if (!step (&x, &y, d, wrap))
+      continue ;
+    if ((board.cell [y][x] == PR_BODY) || (board.cell [y][x] == PR_WALL))
+      continue ;
+    dist = distance (x, y, board.foodX, board.foodY, wrap) ;
+    if (dist < bestDist)
+    {
+      best = d ;
+      bestDist = dist ;
+    }
+  }
+
+  return (best < 0) ? dir : (SNAKE_DIR)best ;
+}
+
+
+int main (int argc, char *argv [])
+{
+  static uint16 body [BOARD_W * BOARD_H] ;
+  int opt, games = 1000, maxSteps = 100000, wrap = 1, verbose = 0 ;
+  int g, t, wins = 0, deaths = 0, stalls = 0, maxScore = 0 ;
+  unsigned long long seed = 1, steps = 0, scores = 0 ;
+  struct timespec t0, t1 ;
+  double secs ;
+  SNAKE_DIR dir ;
+  SNAKE_GAME *game ;
+
+  while ((opt = getopt (argc, argv, "n:s:t:wv")) != -1)
+  {
+    switch (opt)
+    {
+      case 'n': games    = atoi (optarg) ;              break ;
+      case 's': seed     = strtoull (optarg, NULL, 0) ; break ;
+      case 't': maxSteps = atoi (optarg) ;              break ;
+      case 'w': wrap     = 0 ;                          break ;
+      case 'v': verbose  = 1 ;                          break ;
+      default:
+        fprintf (stderr, "Usage: %s [-n games] [-s seed] [-t steps] [-w] [-v]\n", argv [0]) ;
+        return 1 ;
+    }
+  }
+
+  if ((game = snake_game_create (NULL, 0)) == NULL)
+  {
+    fprintf (stderr, "%s: out of memory\n", argv [0]) ;
+    return 1 ;
+  }
+  snake_set_renderer_r  (game, &simRenderer, &board) ;
+  snake_set_crosswall_r (game, wrap) ;
+
+  clock_gettime (CLOCK_MONOTONIC, &t0) ;
+
+  for (g = 0 ; g < games ; ++g)
+  {
+    memset (board.cell, PR_NULL, sizeof (board.cell)) ;
+    board.score = 0 ;
+    board.over  = LF_LIVE ;
+
+    if (snake_game_init_r (game, 3, DR_RIGHT, 10, 100, seed, (uint64)g) == RTN_ERR)
+    {
+      fprintf (stderr, "game %d: init failed\n", g) ;
+      return 1 ;
+    }
+
+    dir = DR_RIGHT ;
+    for (t = 0 ; (t < maxSteps) && (board.over == LF_LIVE) ; ++t)
+    {
+      snake_get_body_r (game, body, 1) ;
+      dir = choose (body [0] % BOARD_W, body [0] / BOARD_W, dir, wrap) ;
+      snake_move_control_r (game, dir) ;
+      dir = snake_get_dir_r (game) ;
+    }
+    steps += t ;
+
+    if      (board.over == LF_WIN) ++wins ;
+    else if (board.over == LF_DIE) ++deaths ;
+    else                           ++stalls ;
+    scores += board.score ;
+    if (board.score > maxScore)
+      maxScore = board.score ;
+
+    if (verbose)
+      printf ("game %d: %s after %d steps, score %d\n", g,
+        (board.over == LF_WIN) ? "won" : (board.over == LF_DIE) ? "died" : "stopped",
+        t, board.score) ;
+  }
+
+  clock_gettime (CLOCK_MONOTONIC, &t1) ;
+  snake_game_destroy (game) ;
+  secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9 ;
+
+  printf ("%d games on %dx%d: %d won, %d died, %d stopped\n",
+    games, BOARD_W, BOARD_H, wins, deaths, stalls) ;
+  printf ("score: mean %.1f, max %d\n", games ? (double)scores / games : 0.0, maxScore) ;
+  printf ("%llu steps in %.3f s: %.0f steps/s, %.0f games/s, %u cell updates\n",
+    steps, secs, secs > 0 ? steps / secs : 0.0, secs > 0 ? games / secs : 0.0, board.cells) ;
+
+  return 0 ;
+}
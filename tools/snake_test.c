@@ -0,0 +1,418 @@
+/*
+ * snake_test.c:
+ *	Checks for the game engine, run on the host by make test. Exits
+ *	non-zero, naming the check, if any fails.
+ *
+ *	Usage: snake_test [-d]
+ *
+ *	-d            Only print a digest of a fixed set of games, so that
+ *	              builds with and without SNAKE_PACKED_BODY can be
+ *	              compared
+ *
+ * Copyright (c) 2015 WHJWNAVY.
+ ***********************************************************************
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ ***********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lcd_snake.h"
+
+#define	BOARD_W   (SnakeMaxX / SnakePtSize)
+#define	BOARD_H   (SnakeMaxY / SnakePtSize)
+#define	CELLS     (BOARD_W * BOARD_H)
+
+// The board as the renderer has drawn it
+
+struct view
+{
+  uint8  cell [CELLS] ;
+  int32  score ;
+  int32  over ;
+} ;
+
+static int failures = 0 ;
+
+#define	CHECK(cond, ...)						\
+  do { if (!(cond)) { printf ("FAIL: " __VA_ARGS__) ; printf ("\n") ;	\
+                      ++failures ; return ; } } while (0)
+
+
+/*
+ * viewCell: viewScore: viewOver:
+ *	A renderer that keeps a struct view up to date.
+ *********************************************************************************
+ */
+static void viewCell (void *arg, int32 x, int32 y, SNAKE_PROPY spropy)
+{
+  ((struct view *)arg)->cell [y * BOARD_W + x] = (uint8)spropy ;
+}
+
+static void viewScore (void *arg, int32 score)
+{
+  ((struct view *)arg)->score = score ;
+}
+
+static void viewOver (void *arg, SNAKE_LIFE life)
+{
+  ((struct view *)arg)->over = life ;
+}
+
+static const SNAKE_RENDERER viewRenderer = { viewCell, viewScore, viewOver } ;
+
+static void viewReset (struct view *v)
+{
+  memset (v->cell, PR_NULL, sizeof (v->cell)) ;
+  v->score = 0 ;
+  v->over  = LF_LIVE ;
+}
+
+
+/*
+ * newGame:
+ *	A game drawn into v, started with the given settings.
+ *********************************************************************************
+ */
+static SNAKE_GAME *newGame (struct view *v, int32 len, SNAKE_DIR dir, int32 crosswall,
+  uint64 seed, uint64 stream)
+{
+  SNAKE_GAME *game = snake_game_create (NULL, 0) ;
+
+  if (game == NULL)
+  {
+    printf ("FAIL: snake_game_create\n") ;
+    exit (1) ;
+  }
+  viewReset (v) ;
+  snake_set_renderer_r  (game, &viewRenderer, v) ;
+  snake_set_crosswall_r (game, crosswall) ;
+  if (snake_game_init_r (game, len, dir, 10, 100, seed, stream) != RTN_OK)
+  {
+    printf ("FAIL: snake_game_init_r (%d, %d, %llu, %llu)\n", len, dir, seed, stream) ;
+    exit (1) ;
+  }
+
+  return game ;
+}
+
+
+/*
+ * randomMove:
+ *	A move that is usually straight on, from a little LCG of our own.
+ *********************************************************************************
+ */
+static SNAKE_DIR randomMove (SNAKE_GAME *game, uint32 *state)
+{
+  *state = *state * 1664525 + 1013904223 ;
+  return ((*state >> 28) < 4) ? (SNAKE_DIR)((*state >> 24) & 3) : snake_get_dir_r (game) ;
+}
+
+
+/*
+ * viewMatches:
+ *	Whether the renderer's board agrees with the body the engine
+ *	reports: the head, then the body, in exactly the cells of
+ *	snake_get_body_r, and one food while the game is live.
+ *********************************************************************************
+ */
+static const char *viewMatches (SNAKE_GAME *game, const struct view *v)
+{
+  static uint16 body [CELLS] ;
+  static uint8  mine [CELLS] ;
+  int32 n, i, snake = 0, food = 0 ;
+
+  n = snake_get_body_r (game, body, CELLS) ;
+  if (n < 1)
+    return "empty body" ;
+
+  memset (mine, 0, sizeof (mine)) ;
+  for (i = 0 ; i < n ; ++i)
+  {
+    if (mine [body [i]])
+      return "body crosses itself" ;
+    mine [body [i]] = 1 ;
+    if (v->cell [body [i]] != ((i == 0) ? PR_HEAD : PR_BODY))
+      return "body cell not drawn as head or body" ;
+  }
+
+  for (i = 0 ; i < CELLS ; ++i)
+  {
+    if ((v->cell [i] == PR_HEAD) || (v->cell [i] == PR_BODY))
+      ++snake ;
+    else if (v->cell [i] == PR_FOOD)
+      ++food ;
+  }
+
+  if (snake != n)
+    return "drawn snake cells differ from body length" ;
+  if ((snake_get_life_r (game) == LF_LIVE) && (food != 1))
+    return "not exactly one food" ;
+  if (v->score != snake_get_score_r (game))
+    return "score not reported" ;
+
+  return NULL ;
+}
+
+
+/*
+ * playDigest:
+ *	Play a game with random moves and hash what happens, for comparing
+ *	replays and builds.
+ *********************************************************************************
+ */
+static uint32 playDigest (int32 len, int32 crosswall, uint64 seed, uint64 stream, uint32 moves)
+{
+  static uint16 body [CELLS] ;
+  struct view v ;
+  SNAKE_GAME *game = newGame (&v, len, DR_RIGHT, crosswall, seed, stream) ;
+  uint32 h = 2166136261u ;
+  int32 t, n, i ;
+
+  for (t = 0 ; (t < 2000) && (snake_get_life_r (game) == LF_LIVE) ; ++t)
+  {
+    snake_move_control_r (game, randomMove (game, &moves)) ;
+    n = snake_get_body_r (game, body, CELLS) ;
+    for (i = 0 ; i < n ; ++i)
+      h = (h ^ body [i]) * 16777619u ;
+    h = (h ^ (uint32)snake_get_score_r (game)) * 16777619u ;
+  }
+  h = (h ^ (uint32)(t << 2 | snake_get_life_r (game))) * 16777619u ;
+
+  snake_game_destroy (game) ;
+  return h ;
+}
+
+
+/*
+ * testReplay:
+ *	The same seed and stream, with the same moves, replay the same game.
+ *********************************************************************************
+ */
+static void testReplay (void)
+{
+  uint64 s ;
+  int differ = 0 ;
+
+  for (s = 0 ; s < 32 ; ++s)
+  {
+    CHECK (playDigest (3, s & 1, s, s / 3, (uint32)s) == playDigest (3, s & 1, s, s / 3, (uint32)s),
+      "replay of seed %llu differs", s) ;
+    differ += playDigest (3, 1, s, 0, 7) != playDigest (3, 1, s, 1, 7) ;
+  }
+  CHECK (differ > 0, "changing the stream never changed the game") ;
+}
+
+
+/*
+ * testRenderer:
+ *	After every step of many games, the renderer's board matches the
+ *	body the engine reports.
+ *********************************************************************************
+ */
+static void testRenderer (void)
+{
+  struct view v ;
+  SNAKE_GAME *game ;
+  const char *err ;
+  uint32 moves ;
+  int32 g, t ;
+
+  for (g = 0 ; g < 200 ; ++g)
+  {
+    moves = (uint32)g ;
+    game  = newGame (&v, 1 + g % 5, (SNAKE_DIR)(g % 4), g & 1, (uint64)g, (uint64)(g % 7)) ;
+    err   = viewMatches (game, &v) ;
+    for (t = 0 ; (err == NULL) && (t < 3000) && (snake_get_life_r (game) == LF_LIVE) ; ++t)
+    {
+      snake_move_control_r (game, randomMove (game, &moves)) ;
+      err = viewMatches (game, &v) ;
+    }
+    CHECK ((err != NULL) || (v.over == (int32)snake_get_life_r (game)),
+      "game %d: game over not reported", g) ;
+    snake_game_destroy (game) ;
+    CHECK (err == NULL, "game %d, step %d: %s", g, t, err) ;
+  }
+}
+
+
+/*
+ * testLengthOne:
+ *	A snake of one segment leaves nothing behind when it moves.
+ *********************************************************************************
+ */
+static void testLengthOne (void)
+{
+  static uint16 body [CELLS] ;
+  struct view v ;
+  SNAKE_GAME *game ;
+  const char *err ;
+  int32 s, d, t ;
+
+  for (s = 0 ; s < 50 ; ++s)
+    for (d = 0 ; d < 4 ; ++d)
+    {
+      game = newGame (&v, 1, (SNAKE_DIR)d, 1, (uint64)s, 0) ;
+      for (t = 0 ; t < 512 ; ++t)
+      {
+        snake_move_control_r (game, (SNAKE_DIR)((t / 5 % 2) ? DR_DOWN : d)) ;
+        if ((err = viewMatches (game, &v)) != NULL)
+          break ;
+        if (snake_get_score_r (game) == 0)
+          CHECK (snake_get_body_r (game, body, CELLS) == 1, "seed %d: length grew", s) ;
+      }
+      snake_game_destroy (game) ;
+      CHECK (err == NULL, "seed %d, dir %d, step %d: %s", s, d, t, err) ;
+    }
+}
+
+
+/*
+ * testCreate:
+ *	Games in caller memory: too small or misaligned memory is refused,
+ *	and games side by side in one block don't disturb each other.
+ *********************************************************************************
+ */
+static void testCreate (void)
+{
+  int32 size = snake_game_size (), i ;
+  uint64 *pool = malloc ((size_t)size * 4 + 8) ;
+  char *mem = (char *)pool ;
+  SNAKE_GAME *games [4] ;
+  SNAKE_DIR d ;
+  uint32 moves ;
+
+  CHECK (pool != NULL, "out of memory") ;
+  CHECK (snake_game_create (mem, size - 1) == NULL, "accepted too little memory") ;
+  CHECK (snake_game_create (mem + 4, size) == NULL, "accepted misaligned memory") ;
+
+  size = (size + 7) & ~7 ;
+  for (i = 0 ; i < 4 ; ++i)
+  {
+    games [i] = snake_game_create (mem + i * size, size) ;
+    CHECK (games [i] == (SNAKE_GAME *)(mem + i * size), "refused slot %d", i) ;
+    snake_game_init_r (games [i], 3, DR_RIGHT, 10, 100, 5, 0) ;
+  }
+
+  // Step them in turn; they all play the same game as one played alone
+
+  moves = 11 ;
+  while (snake_get_life_r (games [0]) == LF_LIVE)
+  {
+    d = randomMove (games [0], &moves) ;
+    for (i = 0 ; i < 4 ; ++i)
+      snake_move_control_r (games [i], d) ;
+  }
+  for (i = 1 ; i < 4 ; ++i)
+    CHECK ((snake_get_score_r (games [i]) == snake_get_score_r (games [0])) &&
+           (snake_get_life_r (games [i]) == LF_DIE), "slot %d played a different game", i) ;
+
+  for (i = 0 ; i < 4 ; ++i)
+    snake_game_destroy (games [i]) ;
+  free (pool) ;
+}
+
+
+/*
+ * cycleDir:
+ *	The move from x, y along a cycle through every cell: along row 0,
+ *	back and forth over columns 1 .. W-1 of the other rows, and up
+ *	column 0. A snake following it can't run into itself.
+ *********************************************************************************
+ */
+static SNAKE_DIR cycleDir (int32 x, int32 y)
+{
+  if (y == 0)
+    return (x == BOARD_W - 1) ? DR_DOWN : DR_RIGHT ;
+  if (x == 0)
+    return DR_UP ;
+  if (y % 2)					// going left
+    return (x == 1) ? ((y == BOARD_H - 1) ? DR_LEFT : DR_DOWN) : DR_LEFT ;
+  return (x == BOARD_W - 1) ? DR_DOWN : DR_RIGHT ;
+}
+
+
+/*
+ * testFill:
+ *	Following the cycle eats every food; the last food goes on the one
+ *	free cell and filling the board wins.
+ *********************************************************************************
+ */
+static void testFill (void)
+{
+  static uint16 body [CELLS] ;
+  struct view v ;
+  SNAKE_GAME *game ;
+  const char *err = NULL ;
+  int32 s, t, n, i, head, food, lastFood ;
+
+  for (s = 0 ; s < 4 ; ++s)
+  {
+    game = newGame (&v, 1, DR_RIGHT, 0, (uint64)s, 0) ;
+    lastFood = 0 ;
+
+    for (t = 0 ; (t < CELLS * CELLS) && (snake_get_life_r (game) == LF_LIVE) ; ++t)
+    {
+      snake_get_body_r (game, body, 1) ;
+      head = body [0] ;
+      snake_set_dir_r (game, cycleDir (head % BOARD_W, head / BOARD_W)) ;
+      snake_move_control_r (game, snake_get_dir_r (game)) ;
+      if ((err = viewMatches (game, &v)) != NULL)
+        break ;
+
+      n = snake_get_body_r (game, body, CELLS) ;
+      if ((n == CELLS - 1) && !lastFood)
+      {
+        for (food = 0 ; (food < CELLS) && (v.cell [food] != PR_FOOD) ; ++food)
+          ;
+        for (i = 0 ; (i < n) && (body [i] != food) ; ++i)
+          ;
+        CHECK ((food < CELLS) && (i == n), "seed %d: last food not on the free cell", s) ;
+        lastFood = 1 ;
+      }
+    }
+
+    CHECK (err == NULL, "seed %d, step %d: %s", s, t, err) ;
+    CHECK (snake_get_life_r (game) == LF_WIN, "seed %d: board filled without a win", s) ;
+    CHECK (v.over == LF_WIN, "seed %d: win not reported", s) ;
+    CHECK (lastFood, "seed %d: never one cell short of full", s) ;
+    CHECK (snake_get_body_r (game, body, CELLS) == CELLS, "seed %d: snake doesn't fill the board", s) ;
+    CHECK (snake_get_score_r (game) == CELLS - 1, "seed %d: score %d", s, snake_get_score_r (game)) ;
+    snake_game_destroy (game) ;
+  }
+}
+
+
+int main (int argc, char *argv [])
+{
+  uint32 h = 0 ;
+  int32 g ;
+
+  if ((argc > 1) && (strcmp (argv [1], "-d") == 0))
+  {
+    for (g = 0 ; g < 500 ; ++g)
+      h = h * 31 + playDigest (1 + g % 5, g & 1, (uint64)g, (uint64)(g % 3), (uint32)g) ;
+    printf ("%08x\n", h) ;
+    return 0 ;
+  }
+
+  testCreate () ;
+  testReplay () ;
+  testRenderer () ;
+  testLengthOne () ;
+  testFill () ;
+
+#ifdef SNAKE_PACKED_BODY
+  printf ("snake_test (packed body): ") ;
+#else
+  printf ("snake_test: ") ;
+#endif
+  printf ("%s\n", failures ? "FAILED" : "ok") ;
+  return failures != 0 ;
+}